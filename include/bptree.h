@@ -3,10 +3,11 @@
 
 #include <cstring>
 #include <queue>
+#include <vector>
 #include "node.h"
 #include "utils.h"
 
-// KeyType must overload operator== and operator<=
+// KeyType must overload operator== and operator<=, see use_fingerprints for an optional hashed leaf lookup
 template <class KeyType, size_type Degree>
 class BPlusTree
 {
@@ -35,10 +36,46 @@ public:
     ~BPlusTree();
 
 public:
+    class Finger;
+
     bool find(const key_type &) const;
     bool remove(const key_type &);
     void clear() noexcept;
     void insert(const key_type &);
+    void insert(key_type &&);
+
+    template <class... Args>
+    void emplace(Args &&...);
+
+    // same as above, but start from the leaf the finger visited last and leave it on k's leaf
+    bool find(Finger &, const key_type &) const;
+    bool remove(Finger &, const key_type &);
+    void insert(Finger &, const key_type &);
+    void insert(Finger &, key_type &&);
+
+    template <class... Args>
+    void emplace_hint(Finger &, Args &&...);
+
+    // [first, last) must be ascending, equal keys are collapsed
+    template <class ForwardIt>
+    void bulk_load(ForwardIt, ForwardIt);
+
+protected:
+    INode *seek(Finger &, const key_type &, size_type &) const;
+    bool remove_from(INode *, size_type, const key_type &);
+
+    template <class K>
+    void insert_impl(K &&);
+    template <class K>
+    void insert_impl(Finger &, K &&);
+    template <class K>
+    void insert_into(INode *, size_type, K &&);
+
+    static size_type locate_key(const LNode *, const key_type &);
+
+    // at most fill keys per leafnode, fewer leaves room for inserts before the first split
+    template <class ForwardIt>
+    static LNode *build_leaves(ForwardIt, ForwardIt, std::vector<Node<key_type, Degree> *> &, size_type fill = Degree - 1);
 
 private:
     void print_to(std::ostream &) const;
@@ -46,6 +83,28 @@ private:
 protected:
     INode *root = nullptr;
     LNode *data = nullptr;
+    size_type version = 0; // bumped whenever indexnodes are created, destroyed or reshaped
+};
+
+/**
+ * Cached root-to-leaf path of one tree. Each level keeps pointers to the separators that
+ * bound its key range, so in-place separator updates are seen for free and only a change
+ * of the tree's version forces a fresh descent. A finger must not outlive its tree.
+ */
+template <class KeyType, size_type Degree>
+class BPlusTree<KeyType, Degree>::Finger
+{
+    friend class BPlusTree;
+
+    struct Level
+    {
+        INode *inode;
+        const key_type *lower, *upper; // inode covers [*lower, *upper), nullptr is unbounded
+    };
+
+    std::vector<Level> path; // root first, leaf-level indexnode last
+    const BPlusTree *owner = nullptr;
+    size_type version = 0;
 };
 
 template <class KeyType, size_type Degree>
@@ -54,6 +113,7 @@ inline BPlusTree<KeyType, Degree>::BPlusTree(BPlusTree &&other) noexcept
 {
     other.root = nullptr;
     other.data = nullptr;
+    ++other.version;
 }
 
 template <class KeyType, size_type Degree>
@@ -66,6 +126,7 @@ BPlusTree<KeyType, Degree> &BPlusTree<KeyType, Degree>::operator=(BPlusTree &&ot
         data = other.data;
         other.root = nullptr;
         other.data = nullptr;
+        ++other.version;
     }
     return *this;
 }
@@ -87,30 +148,119 @@ bool BPlusTree<KeyType, Degree>::find(const key_type &k) const
             LNode *lnode = nullptr;
             size_type child_idx;
 
+            // separators may outlive their keys, so only a leafnode can answer
             while (ChildType::INDEX == inode->child_type)
-            {
-                child_idx = locate_insert(inode->keys, inode->key_count, k);
-
-                if (child_idx && k == inode->keys[child_idx - 1]) // if indexnode has keyword k
-                    return true;
-
-                inode = static_cast<INode *>(inode->children[child_idx]);
-            }
+                inode = static_cast<INode *>(inode->children[locate_insert(inode->keys, inode->key_count, k)]);
             child_idx = locate_insert(inode->keys, inode->key_count, k);
 
-            if (child_idx && k == inode->keys[child_idx - 1]) // if indexnode has keyword k
-                return true;
-
             lnode = static_cast<LNode *>(inode->children[child_idx]);
-            return size_type(-1) != locate_value(lnode->keys, lnode->key_count, k);
+            return size_type(-1) != locate_key(lnode, k);
         }
         else // there is no indexnodes
-            return size_type(-1) != locate_value(data->keys, data->key_count, k);
+            return size_type(-1) != locate_key(data, k);
     }
     else
         return false;
 }
 
+template <class KeyType, size_type Degree>
+bool BPlusTree<KeyType, Degree>::find(Finger &f, const key_type &k) const
+{
+    if (!root)
+        return find(k);
+
+    size_type child_idx;
+    INode *inode = seek(f, k, child_idx);
+
+    return size_type(-1) != locate_key(static_cast<LNode *>(inode->children[child_idx]), k);
+}
+
+template <class KeyType, size_type Degree>
+bool BPlusTree<KeyType, Degree>::remove(Finger &f, const key_type &k)
+{
+    if (!root)
+        return remove(k);
+
+    size_type child_idx;
+    INode *inode = seek(f, k, child_idx);
+
+    return remove_from(inode, child_idx, k);
+}
+
+template <class KeyType, size_type Degree>
+inline void BPlusTree<KeyType, Degree>::insert(Finger &f, const key_type &k)
+{
+    insert_impl(f, k);
+}
+
+template <class KeyType, size_type Degree>
+inline void BPlusTree<KeyType, Degree>::insert(Finger &f, key_type &&k)
+{
+    insert_impl(f, std::move(k));
+}
+
+template <class KeyType, size_type Degree>
+template <class... Args>
+inline void BPlusTree<KeyType, Degree>::emplace_hint(Finger &f, Args &&...args)
+{
+    insert_impl(f, key_type(std::forward<Args>(args)...));
+}
+
+template <class KeyType, size_type Degree>
+template <class K>
+void BPlusTree<KeyType, Degree>::insert_impl(Finger &f, K &&k)
+{
+    if (!root)
+        return insert_impl(std::forward<K>(k));
+
+    size_type child_idx;
+    INode *inode = seek(f, k, child_idx);
+
+    insert_into(inode, child_idx, std::forward<K>(k));
+}
+
+// climb the cached path only until k is in range, then descend to the leaf-level indexnode
+template <class KeyType, size_type Degree>
+typename BPlusTree<KeyType, Degree>::INode *
+BPlusTree<KeyType, Degree>::seek(Finger &f, const key_type &k, size_type &child_idx) const
+{
+    size_type depth = f.path.size();
+
+    if (this != f.owner || version != f.version || !depth)
+    {
+        typename Finger::Level level = {root, nullptr, nullptr};
+
+        f.path.assign(1, level);
+        f.owner = this;
+        f.version = version;
+    }
+    else
+    {
+        while (depth > 1 && ((f.path[depth - 1].lower && !(*f.path[depth - 1].lower <= k)) ||
+                             (f.path[depth - 1].upper && *f.path[depth - 1].upper <= k)))
+            --depth;
+
+        f.path.resize(depth);
+    }
+
+    INode *inode = f.path.back().inode;
+    child_idx = locate_insert(inode->keys, inode->key_count, k);
+
+    while (ChildType::INDEX == inode->child_type)
+    {
+        const typename Finger::Level &dad = f.path.back();
+        typename Finger::Level level = {static_cast<INode *>(inode->children[child_idx]),
+                                        child_idx ? inode->keys + child_idx - 1 : dad.lower,
+                                        child_idx < inode->key_count ? inode->keys + child_idx : dad.upper};
+
+        f.path.push_back(level);
+        inode = level.inode;
+        child_idx = locate_insert(inode->keys, inode->key_count, k);
+    }
+
+    return inode;
+}
+
 template <class KeyType, size_type Degree>
 bool BPlusTree<KeyType, Degree>::remove(const key_type &k)
 {
@@ -118,7 +268,13 @@ bool BPlusTree<KeyType, Degree>::remove(const key_type &k)
         return false;
     else if (!root)
     {
-        bool flag = remove_value(data->keys, data->key_count, k);
+        size_type k_idx = locate_key(data, k);
+
+        if (size_type(-1) == k_idx) // can not find k
+            return false;
+
+        remove_at(data->keys, data->key_count, k_idx);
+        data->fingerprints.remove(data->key_count, k_idx);
 
         if (!data->key_count)
         {
@@ -126,264 +282,273 @@ bool BPlusTree<KeyType, Degree>::remove(const key_type &k)
             data = nullptr;
         }
 
-        return flag;
+        return true;
     }
     else
     {
         INode *inode = root;
-        LNode *lnode = nullptr;
-        size_type child_idx, k_idx;
 
         while (ChildType::INDEX == inode->child_type)
-        {
-            child_idx = locate_insert(inode->keys, inode->key_count, k);
-            inode = static_cast<INode *>(inode->children[child_idx]);
-        }
+            inode = static_cast<INode *>(inode->children[locate_insert(inode->keys, inode->key_count, k)]);
 
-        child_idx = locate_insert(inode->keys, inode->key_count, k);
-        lnode = static_cast<LNode *>(inode->children[child_idx]);
-        k_idx = locate_value(lnode->keys, lnode->key_count, k);
+        return remove_from(inode, locate_insert(inode->keys, inode->key_count, k), k);
+    }
+}
 
-        if (size_type(-1) == k_idx) // can not find k
-            return false;
-        else // find k
+// inode is the leaf-level indexnode whose child_idx-th child holds k
+template <class KeyType, size_type Degree>
+bool BPlusTree<KeyType, Degree>::remove_from(INode *inode, size_type child_idx, const key_type &k)
+{
+    LNode *lnode = static_cast<LNode *>(inode->children[child_idx]);
+    size_type k_idx = locate_key(lnode, k);
+
+    if (size_type(-1) == k_idx) // can not find k
+        return false;
+    else // find k
+    {
+        const size_type NODE_MIN_LEN = Degree & 1 ? Degree >> 1 : (Degree >> 1) - 1;
+        remove_at(lnode->keys, lnode->key_count, k_idx);
+        lnode->fingerprints.remove(lnode->key_count, k_idx);
+
+        if (lnode->key_count < NODE_MIN_LEN) // lnode borrow or merge
         {
-            const size_type NODE_MIN_LEN = Degree & 1 ? Degree >> 1 : (Degree >> 1) - 1;
-            remove_at(lnode->keys, lnode->key_count, k_idx);
+            ++version;
+
+            size_type bro_idx;
+            LNode *bro_lnode = nullptr;
 
-            if (lnode->key_count < NODE_MIN_LEN) // lnode borrow or merge
+            if (!child_idx)
             {
-                size_type bro_idx;
-                LNode *bro_lnode = nullptr;
+                bro_idx = 1;
+                bro_lnode = lnode->next;
+            }
+            else
+            {
+                bro_idx = child_idx - 1;
+                bro_lnode = static_cast<LNode *>(inode->children[bro_idx]);
 
-                if (!child_idx)
+                if (child_idx != inode->key_count && bro_lnode->key_count == NODE_MIN_LEN && lnode->next->key_count != NODE_MIN_LEN)
                 {
-                    bro_idx = 1;
+                    bro_idx = child_idx + 1;
                     bro_lnode = lnode->next;
                 }
+            }
+
+            if (bro_lnode->key_count != NODE_MIN_LEN) // lnode borrow
+            {
+                if (bro_idx < child_idx)
+                {
+                    --bro_lnode->key_count;
+                    insert_at(lnode->keys, lnode->key_count, std::move(bro_lnode->keys[bro_lnode->key_count]), 0);
+                    lnode->fingerprints.insert(lnode->keys, lnode->key_count, 0);
+                    inode->keys[bro_idx] = lnode->keys[0];
+                }
                 else
                 {
-                    bro_idx = child_idx - 1;
-                    bro_lnode = static_cast<LNode *>(inode->children[bro_idx]);
+                    lnode->keys[lnode->key_count] = std::move(bro_lnode->keys[0]);
+                    bro_lnode->fingerprints.copy_to(0, 1, lnode->fingerprints, lnode->key_count);
+                    ++lnode->key_count;
+                    remove_at(bro_lnode->keys, bro_lnode->key_count, 0);
+                    bro_lnode->fingerprints.remove(bro_lnode->key_count, 0);
+                    inode->keys[child_idx] = bro_lnode->keys[0];
+                }
+            }
+            else // lnode merge
+            {
+                // Determine the value of bro_inode
+                if (bro_idx < child_idx)
+                {
+                    move_n(lnode->keys, lnode->key_count, bro_lnode->keys + bro_lnode->key_count);
+                    lnode->fingerprints.copy_to(0, lnode->key_count, bro_lnode->fingerprints, bro_lnode->key_count);
+                    bro_lnode->key_count += lnode->key_count;
+                    bro_lnode->next = lnode->next;
 
-                    if (child_idx != inode->key_count && bro_lnode->key_count == NODE_MIN_LEN && lnode->next->key_count != NODE_MIN_LEN)
-                    {
-                        bro_idx = child_idx + 1;
-                        bro_lnode = lnode->next;
-                    }
+                    delete lnode;
+                    lnode = bro_lnode;
+
+                    remove_at(inode->keys, inode->key_count, bro_idx);
+                    remove_at(inode->children, inode->child_count, child_idx);
                 }
+                else
+                {
+                    move_n(bro_lnode->keys, bro_lnode->key_count, lnode->keys + lnode->key_count);
+                    bro_lnode->fingerprints.copy_to(0, bro_lnode->key_count, lnode->fingerprints, lnode->key_count);
+                    lnode->key_count += bro_lnode->key_count;
+                    lnode->next = bro_lnode->next;
 
-                if (bro_lnode->key_count != NODE_MIN_LEN) // lnode borrow
+                    delete bro_lnode;
+
+                    remove_at(inode->keys, inode->key_count, child_idx);
+                    remove_at(inode->children, inode->child_count, bro_idx);
+                }
+
+                if (!child_idx && !k_idx) // update ancestor inode
                 {
-                    if (bro_idx < child_idx)
-                    {
-                        --bro_lnode->key_count;
-                        insert_at(lnode->keys, lnode->key_count, bro_lnode->keys[bro_lnode->key_count], 0);
-                    }
-                    else
+                    INode *dad_inode = nullptr, *inode_cpy = inode;
+
+                    while (dad_inode = inode->father)
                     {
-                        lnode->keys[lnode->key_count] = bro_lnode->keys[0];
-                        ++lnode->key_count;
-                        remove_at(bro_lnode->keys, bro_lnode->key_count, 0);
+                        if (static_cast<INode *>(dad_inode->children[0]) == inode)
+                            inode = dad_inode;
+                        else
+                        {
+                            child_idx = locate_value(dad_inode->children, dad_inode->child_count,
+                                                     static_cast<Node<KeyType, Degree> *>(inode));
+                            inode = dad_inode;
+                            break;
+                        }
                     }
+
+                    if (child_idx)
+                        inode->keys[child_idx - 1] = lnode->keys[0];
+                    inode = inode_cpy;
                 }
-                else // lnode merge
-                {
-                    // Determine the value of bro_inode
-                    if (bro_idx < child_idx)
-                    {
-                        std::memcpy(bro_lnode->keys + bro_lnode->key_count, lnode->keys,
-                                    sizeof(key_type) * lnode->key_count);
-                        bro_lnode->key_count += lnode->key_count;
-                        bro_lnode->next = lnode->next;
 
-                        delete lnode;
-                        lnode = bro_lnode;
+                while (inode != root && inode->key_count < NODE_MIN_LEN)
+                {
+                    INode *dad_inode = inode->father, *bro_inode = nullptr;
+                    child_idx = locate_value(dad_inode->children, dad_inode->child_count,
+                                             static_cast<Node<key_type, Degree> *>(inode));
 
-                        remove_at(inode->keys, inode->key_count, bro_idx);
-                        remove_at(inode->children, inode->child_count, child_idx);
+                    if (!child_idx)
+                    {
+                        bro_idx = 1;
+                        bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
                     }
                     else
                     {
-                        std::memcpy(lnode->keys + lnode->key_count, bro_lnode->keys,
-                                    sizeof(key_type) * bro_lnode->key_count);
-                        lnode->key_count += bro_lnode->key_count;
-                        lnode->next = bro_lnode->next;
-
-                        delete bro_lnode;
+                        bro_idx = child_idx - 1;
+                        bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
 
-                        remove_at(inode->keys, inode->key_count, child_idx);
-                        remove_at(inode->children, inode->child_count, bro_idx);
+                        if (child_idx != dad_inode->key_count && bro_inode->key_count == NODE_MIN_LEN && dad_inode->children[child_idx + 1]->key_count != NODE_MIN_LEN)
+                        {
+                            bro_idx = child_idx + 1;
+                            bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
+                        }
                     }
 
-                    if (!child_idx && !k_idx) // update ancestor inode
-                    {
-                        INode *dad_inode = nullptr, *inode_cpy = inode;
-
-                        while (dad_inode = inode->father)
+                    if (bro_inode->key_count != NODE_MIN_LEN) // inode borrow
+                        if (bro_idx < child_idx)              // borrow left
                         {
-                            if (static_cast<INode *>(dad_inode->children[0]) == inode)
-                                inode = dad_inode;
-                            else
-                            {
-                                child_idx = locate_value(dad_inode->children, dad_inode->child_count,
-                                                         static_cast<Node<KeyType, Degree> *>(inode));
-                                inode = dad_inode;
-                                break;
-                            }
+                            insert_at(inode->keys, inode->key_count, std::move(dad_inode->keys[bro_idx]), 0);
+
+                            --bro_inode->key_count;
+                            dad_inode->keys[bro_idx] = std::move(bro_inode->keys[bro_inode->key_count]);
+
+                            --bro_inode->child_count;
+                            if (ChildType::INDEX == bro_inode->child_type)
+                                static_cast<INode *>(bro_inode->children[bro_inode->child_count])->father = inode;
+                            insert_at(inode->children, inode->child_count, bro_inode->children[bro_inode->child_count], 0);
                         }
+                        else // borrow right
+                        {
+                            inode->keys[inode->key_count] = std::move(dad_inode->keys[child_idx]);
+                            ++inode->key_count;
 
-                        if (child_idx)
-                            inode->keys[child_idx - 1] = lnode->keys[0];
-                        inode = inode_cpy;
-                    }
+                            dad_inode->keys[child_idx] = std::move(bro_inode->keys[0]);
 
-                    while (inode != root && inode->key_count < NODE_MIN_LEN)
-                    {
-                        INode *dad_inode = inode->father, *bro_inode = nullptr;
-                        child_idx = locate_value(dad_inode->children, dad_inode->child_count,
-                                                 static_cast<Node<key_type, Degree> *>(inode));
+                            if (ChildType::INDEX == bro_inode->child_type)
+                                static_cast<INode *>(bro_inode->children[0])->father = inode;
+                            inode->children[inode->child_count] = bro_inode->children[0];
+                            ++inode->child_count;
 
-                        if (!child_idx)
-                        {
-                            bro_idx = 1;
-                            bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
+                            remove_at(bro_inode->keys, bro_inode->key_count, 0);
+                            remove_at(bro_inode->children, bro_inode->child_count, 0);
                         }
-                        else
+
+                    else                         // inode merge
+                        if (bro_idx < child_idx) // merge left
                         {
-                            bro_idx = child_idx - 1;
-                            bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
+                            bro_inode->keys[bro_inode->key_count] = std::move(dad_inode->keys[bro_idx]);
+                            ++bro_inode->key_count;
+                            move_n(inode->keys, inode->key_count, bro_inode->keys + bro_inode->key_count);
+                            bro_inode->key_count += inode->key_count;
 
-                            if (child_idx != dad_inode->key_count && bro_inode->key_count == NODE_MIN_LEN && dad_inode->children[child_idx + 1]->key_count != NODE_MIN_LEN)
-                            {
-                                bro_idx = child_idx + 1;
-                                bro_inode = static_cast<INode *>(dad_inode->children[bro_idx]);
-                            }
-                        }
+                            if (ChildType::INDEX == inode->child_type)
+                                for (size_type i = 0; i < inode->child_count; ++i)
+                                    static_cast<INode *>(inode->children[i])->father = bro_inode;
 
-                        if (bro_inode->key_count != NODE_MIN_LEN) // inode borrow
-                            if (bro_idx < child_idx)              // borrow left
-                            {
-                                insert_at(inode->keys, inode->key_count, dad_inode->keys[bro_idx], 0);
-
-                                --bro_inode->key_count;
-                                dad_inode->keys[bro_idx] = bro_inode->keys[bro_inode->key_count];
-
-                                --bro_inode->child_count;
-                                if (ChildType::INDEX == bro_inode->child_type)
-                                    static_cast<INode *>(bro_inode->children[bro_inode->child_count])->father = inode;
-                                insert_at(inode->children, inode->child_count, bro_inode->children[bro_inode->child_count], 0);
-                            }
-                            else // borrow right
-                            {
-                                inode->keys[inode->key_count] = dad_inode->keys[child_idx];
-                                ++inode->key_count;
-
-                                dad_inode->keys[child_idx] = bro_inode->keys[0];
-
-                                if (ChildType::INDEX == bro_inode->child_type)
-                                    static_cast<INode *>(bro_inode->children[0])->father = inode;
-                                inode->children[inode->child_count] = bro_inode->children[0];
-                                ++inode->child_count;
-
-                                remove_at(bro_inode->keys, bro_inode->key_count, 0);
-                                remove_at(bro_inode->children, bro_inode->child_count, 0);
-                            }
-
-                        else                         // inode merge
-                            if (bro_idx < child_idx) // merge left
-                            {
-                                bro_inode->keys[bro_inode->key_count] = dad_inode->keys[bro_idx];
-                                ++bro_inode->key_count;
-                                std::memcpy(bro_inode->keys + bro_inode->key_count, inode->keys, sizeof(key_type) * inode->key_count);
-                                bro_inode->key_count += inode->key_count;
-
-                                if (ChildType::INDEX == inode->child_type)
-                                    for (size_type i = 0; i < inode->child_count; ++i)
-                                        static_cast<INode *>(inode->children[i])->father = bro_inode;
-
-                                std::memcpy(bro_inode->children + bro_inode->child_count, inode->children, sizeof(Node<key_type, Degree> *) * inode->child_count);
-                                bro_inode->child_count += inode->child_count;
-
-                                remove_at(dad_inode->keys, dad_inode->key_count, bro_idx);
-                                remove_at(dad_inode->children, dad_inode->child_count, child_idx);
-
-                                delete inode;
-                                inode = bro_inode;
-                            }
-                            else // merge right
-                            {
-                                inode->keys[inode->key_count] = dad_inode->keys[child_idx];
-                                ++inode->key_count;
-                                std::memcpy(inode->keys + inode->key_count, bro_inode->keys, sizeof(key_type) * bro_inode->key_count);
-                                inode->key_count += bro_inode->key_count;
-
-                                if (ChildType::INDEX == bro_inode->child_type)
-                                    for (size_type i = 0; i < bro_inode->child_count; ++i)
-                                        static_cast<INode *>(bro_inode->children[i])->father = inode;
-
-                                std::memcpy(inode->children + inode->child_count, bro_inode->children, sizeof(Node<key_type, Degree> *) * bro_inode->child_count);
-                                inode->child_count += bro_inode->child_count;
-
-                                remove_at(dad_inode->keys, dad_inode->key_count, child_idx);
-                                remove_at(dad_inode->children, dad_inode->child_count, bro_idx);
-
-                                delete bro_inode;
-                            }
+                            std::memcpy(bro_inode->children + bro_inode->child_count, inode->children, sizeof(Node<key_type, Degree> *) * inode->child_count);
+                            bro_inode->child_count += inode->child_count;
 
-                        inode = dad_inode;
-                    }
+                            remove_at(dad_inode->keys, dad_inode->key_count, bro_idx);
+                            remove_at(dad_inode->children, dad_inode->child_count, child_idx);
 
-                    if (!root->key_count)
-                    {
-                        if (ChildType::INDEX == root->child_type)
-                        {
-                            inode = root;
-                            root = static_cast<INode *>(root->children[0]);
-                            root->father = nullptr;
                             delete inode;
+                            inode = bro_inode;
                         }
-                        else
+                        else // merge right
                         {
-                            delete root;
-                            root = nullptr;
+                            inode->keys[inode->key_count] = std::move(dad_inode->keys[child_idx]);
+                            ++inode->key_count;
+                            move_n(bro_inode->keys, bro_inode->key_count, inode->keys + inode->key_count);
+                            inode->key_count += bro_inode->key_count;
+
+                            if (ChildType::INDEX == bro_inode->child_type)
+                                for (size_type i = 0; i < bro_inode->child_count; ++i)
+                                    static_cast<INode *>(bro_inode->children[i])->father = inode;
+
+                            std::memcpy(inode->children + inode->child_count, bro_inode->children, sizeof(Node<key_type, Degree> *) * bro_inode->child_count);
+                            inode->child_count += bro_inode->child_count;
+
+                            remove_at(dad_inode->keys, dad_inode->key_count, child_idx);
+                            remove_at(dad_inode->children, dad_inode->child_count, bro_idx);
+
+                            delete bro_inode;
                         }
-                    }
 
-                    return true;
+                    inode = dad_inode;
                 }
+
+                if (!root->key_count)
+                {
+                    if (ChildType::INDEX == root->child_type)
+                    {
+                        inode = root;
+                        root = static_cast<INode *>(root->children[0]);
+                        root->father = nullptr;
+                        delete inode;
+                    }
+                    else
+                    {
+                        delete root;
+                        root = nullptr;
+                    }
+                }
+
+                return true;
             }
+        }
 
-            // update some index
-            if (child_idx)
-                inode->keys[child_idx - 1] = lnode->keys[0]; // update direct father inode
-            else
+        // update some index
+        if (child_idx)
+            inode->keys[child_idx - 1] = lnode->keys[0]; // update direct father inode
+        else
+        {
+            inode->keys[0] = lnode->next->keys[0]; // update direct father inode
+            if (!k_idx)                            // update ancestor inode
             {
-                inode->keys[0] = lnode->next->keys[0]; // update direct father inode
-                if (!k_idx)                            // update ancestor inode
-                {
-                    INode *dad_inode = nullptr;
+                INode *dad_inode = nullptr;
 
-                    while (dad_inode = inode->father)
+                while (dad_inode = inode->father)
+                {
+                    if (static_cast<INode *>(dad_inode->children[0]) == inode)
+                        inode = dad_inode;
+                    else
                     {
-                        if (static_cast<INode *>(dad_inode->children[0]) == inode)
-                            inode = dad_inode;
-                        else
-                        {
-                            child_idx = locate_value(dad_inode->children, dad_inode->child_count,
-                                                     static_cast<Node<KeyType, Degree> *>(inode));
-                            inode = dad_inode;
-                            break;
-                        }
+                        child_idx = locate_value(dad_inode->children, dad_inode->child_count,
+                                                 static_cast<Node<KeyType, Degree> *>(inode));
+                        inode = dad_inode;
+                        break;
                     }
-
-                    if (child_idx)
-                        inode->keys[child_idx - 1] = lnode->keys[0];
                 }
-            }
 
-            return true;
+                if (child_idx)
+                    inode->keys[child_idx - 1] = lnode->keys[0];
+            }
         }
+
+        return true;
     }
 }
 
@@ -409,6 +574,7 @@ void BPlusTree<KeyType, Degree>::clear() noexcept
         }
 
         root = nullptr;
+        ++version;
     }
     if (data)
     {
@@ -427,17 +593,41 @@ void BPlusTree<KeyType, Degree>::clear() noexcept
 }
 
 template <class KeyType, size_type Degree>
-void BPlusTree<KeyType, Degree>::insert(const key_type &k)
+inline void BPlusTree<KeyType, Degree>::insert(const key_type &k)
+{
+    insert_impl(k);
+}
+
+template <class KeyType, size_type Degree>
+inline void BPlusTree<KeyType, Degree>::insert(key_type &&k)
+{
+    insert_impl(std::move(k));
+}
+
+template <class KeyType, size_type Degree>
+template <class... Args>
+inline void BPlusTree<KeyType, Degree>::emplace(Args &&...args)
+{
+    insert_impl(key_type(std::forward<Args>(args)...));
+}
+
+// K is key_type or const key_type &, k is moved into its leafnode at most once and not read afterwards
+template <class KeyType, size_type Degree>
+template <class K>
+void BPlusTree<KeyType, Degree>::insert_impl(K &&k)
 {
     if (!data) // there is no keys
     {
         data = new LNode;
-        data->keys[0] = k;
+        data->keys[0] = std::forward<K>(k);
         data->key_count = 1;
+        data->fingerprints.insert(data->keys, 1, 0);
     }
     else if (!root) // there is no indexnodes
     {
-        insert_value(data->keys, data->key_count, k);
+        size_type pos = locate_insert(data->keys, data->key_count, k);
+        insert_at(data->keys, data->key_count, std::forward<K>(k), pos);
+        data->fingerprints.insert(data->keys, data->key_count, pos);
 
         if (Degree == data->key_count) // need split
         {
@@ -448,8 +638,10 @@ void BPlusTree<KeyType, Degree>::insert(const key_type &k)
             data->next = bro_lnode;
 
             bro_lnode->key_count = Degree - SPLIT_POS;
-            std::memcpy(bro_lnode->keys, data->keys + SPLIT_POS, sizeof(key_type) * bro_lnode->key_count);
+            move_n(data->keys + SPLIT_POS, bro_lnode->key_count, bro_lnode->keys);
+            data->fingerprints.copy_to(SPLIT_POS, bro_lnode->key_count, bro_lnode->fingerprints, 0);
 
+            ++version;
             root = new INode(ChildType::LEAF);
             root->keys[0] = bro_lnode->keys[0];
             root->key_count = 1;
@@ -461,93 +653,210 @@ void BPlusTree<KeyType, Degree>::insert(const key_type &k)
     else
     {
         INode *inode = root;
-        LNode *lnode = nullptr;
-        size_type child_idx;
 
         while (ChildType::INDEX == inode->child_type)
-        {
-            child_idx = locate_insert(inode->keys, inode->key_count, k);
-            inode = static_cast<INode *>(inode->children[child_idx]);
-        }
+            inode = static_cast<INode *>(inode->children[locate_insert(inode->keys, inode->key_count, k)]);
 
-        child_idx = locate_insert(inode->keys, inode->key_count, k);
-        lnode = static_cast<LNode *>(inode->children[child_idx]);
-        insert_value(lnode->keys, lnode->key_count, k);
+        size_type child_idx = locate_insert(inode->keys, inode->key_count, k);
+        insert_into(inode, child_idx, std::forward<K>(k));
+    }
+}
 
-        if (Degree == lnode->key_count) // need split
-        {
-            const size_type SPLIT_POS = Degree >> 1;
-            LNode *bro_lnode = new LNode; // right brother leafnode
+// inode is the leaf-level indexnode whose child_idx-th child receives k
+template <class KeyType, size_type Degree>
+template <class K>
+void BPlusTree<KeyType, Degree>::insert_into(INode *inode, size_type child_idx, K &&k)
+{
+    LNode *lnode = static_cast<LNode *>(inode->children[child_idx]);
+    size_type pos = locate_insert(lnode->keys, lnode->key_count, k);
 
-            bro_lnode->next = lnode->next;
-            bro_lnode->key_count = Degree - SPLIT_POS;
-            std::memcpy(bro_lnode->keys, lnode->keys + SPLIT_POS, sizeof(key_type) * bro_lnode->key_count);
+    insert_at(lnode->keys, lnode->key_count, std::forward<K>(k), pos);
+    lnode->fingerprints.insert(lnode->keys, lnode->key_count, pos);
 
-            lnode->key_count = SPLIT_POS;
-            lnode->next = bro_lnode;
+    if (Degree == lnode->key_count) // need split
+    {
+        const size_type SPLIT_POS = Degree >> 1;
+        LNode *bro_lnode = new LNode; // right brother leafnode
+
+        ++version;
 
-            insert_at(inode->keys, inode->key_count, bro_lnode->keys[0], child_idx);
-            insert_at(inode->children, inode->child_count,
-                      static_cast<Node<key_type, Degree> *>(bro_lnode), child_idx + 1);
+        bro_lnode->next = lnode->next;
+        bro_lnode->key_count = Degree - SPLIT_POS;
+        move_n(lnode->keys + SPLIT_POS, bro_lnode->key_count, bro_lnode->keys);
+        lnode->fingerprints.copy_to(SPLIT_POS, bro_lnode->key_count, bro_lnode->fingerprints, 0);
+
+        lnode->key_count = SPLIT_POS;
+        lnode->next = bro_lnode;
+
+        insert_at(inode->keys, inode->key_count, bro_lnode->keys[0], child_idx);
+        insert_at(inode->children, inode->child_count,
+                  static_cast<Node<key_type, Degree> *>(bro_lnode), child_idx + 1);
+
+        while (Degree == inode->key_count) // father indexnodes need split
+        {
+            bool exit_loop = false;
+            INode *dad_inode = nullptr, *bro_inode = new INode(inode->child_type);
 
-            while (Degree == inode->key_count) // father indexnodes need split
+            if (inode->father)
             {
-                bool exit_loop = false;
-                INode *dad_inode = nullptr, *bro_inode = new INode(inode->child_type);
+                dad_inode = inode->father;
+                child_idx = locate_value(dad_inode->children, dad_inode->child_count, static_cast<Node<KeyType, Degree> *>(inode));
 
-                if (inode->father)
-                {
-                    dad_inode = inode->father;
-                    child_idx = locate_value(dad_inode->children, dad_inode->child_count, static_cast<Node<KeyType, Degree> *>(inode));
+                insert_at(dad_inode->keys, dad_inode->key_count, std::move(inode->keys[SPLIT_POS]), child_idx);
+                insert_at(dad_inode->children, dad_inode->child_count,
+                          static_cast<Node<KeyType, Degree> *>(bro_inode), child_idx + 1);
+            }
+            else
+            {
+                exit_loop = true;
+                dad_inode = new INode(ChildType::INDEX);
 
-                    insert_at(dad_inode->keys, dad_inode->key_count, inode->keys[SPLIT_POS], child_idx);
-                    insert_at(dad_inode->children, dad_inode->child_count,
-                              static_cast<Node<KeyType, Degree> *>(bro_inode), child_idx + 1);
-                }
-                else
-                {
-                    exit_loop = true;
-                    dad_inode = new INode(ChildType::INDEX);
+                dad_inode->keys[0] = std::move(inode->keys[SPLIT_POS]);
+                dad_inode->key_count = 1;
+                dad_inode->children[0] = inode;
+                dad_inode->children[1] = bro_inode;
+                dad_inode->child_count = 2;
 
-                    dad_inode->keys[0] = inode->keys[SPLIT_POS];
-                    dad_inode->key_count = 1;
-                    dad_inode->children[0] = inode;
-                    dad_inode->children[1] = bro_inode;
-                    dad_inode->child_count = 2;
+                inode->father = dad_inode;
+                root = dad_inode;
+            }
 
-                    inode->father = dad_inode;
-                }
+            inode->key_count = SPLIT_POS;
+            inode->child_count = SPLIT_POS + 1;
 
-                inode->key_count = SPLIT_POS;
-                inode->child_count = SPLIT_POS + 1;
+            bro_inode->key_count = Degree - SPLIT_POS - 1;
+            move_n(inode->keys + SPLIT_POS + 1, bro_inode->key_count, bro_inode->keys);
+            bro_inode->child_count = bro_inode->key_count + 1;
+            std::memcpy(bro_inode->children, inode->children + inode->child_count,
+                        sizeof(Node<key_type, Degree> *) * bro_inode->child_count);
+            bro_inode->father = dad_inode;
 
-                bro_inode->key_count = Degree - SPLIT_POS - 1;
-                std::memcpy(bro_inode->keys, inode->keys + SPLIT_POS + 1,
-                            sizeof(key_type) * bro_inode->key_count);
-                bro_inode->child_count = bro_inode->key_count + 1;
-                std::memcpy(bro_inode->children, inode->children + inode->child_count,
-                            sizeof(Node<key_type, Degree> *) * bro_inode->child_count);
-                bro_inode->father = dad_inode;
+            if (ChildType::INDEX == bro_inode->child_type)
+                for (size_type i = 0; i < bro_inode->child_count; ++i)
+                    static_cast<INode *>(bro_inode->children[i])->father = bro_inode;
 
-                if (ChildType::INDEX == bro_inode->child_type)
-                    for (size_type i = 0; i < bro_inode->child_count; ++i)
-                        static_cast<INode *>(bro_inode->children[i])->father = bro_inode;
+            if (exit_loop)
+                break;
+            else
+                inode = inode->father;
+        }
+    }
+    else // Degree != lnode->key_count, do not need split
+        if (child_idx)
+            inode->keys[child_idx - 1] = lnode->keys[0];
+}
 
-                if (exit_loop)
-                    break;
-                else
-                    inode = inode->father;
+template <class KeyType, size_type Degree>
+template <class ForwardIt>
+void BPlusTree<KeyType, Degree>::bulk_load(ForwardIt first, ForwardIt last)
+{
+    std::vector<Node<key_type, Degree> *> level;
+
+    clear();
+    data = build_leaves(first, last, level);
+
+    if (level.size() < 2) // there is no indexnodes
+        return;
+
+    // separators[i] is the smallest key below level[i]
+    std::vector<key_type> separators;
+    separators.reserve(level.size());
+    for (size_type i = 0; i < level.size(); ++i)
+        separators.push_back(level[i]->keys[0]);
+
+    ChildType child_type = ChildType::LEAF;
+
+    while (level.size() > 1) // build one level of indexnodes per pass
+    {
+        const size_type CHILD_CNT = level.size();
+        const size_type INODE_CNT = (CHILD_CNT + Degree - 1) / Degree;
+        const size_type BASE = CHILD_CNT / INODE_CNT, EXTRA = CHILD_CNT % INODE_CNT;
+        size_type pos = 0;
+
+        for (size_type i = 0; i < INODE_CNT; ++i)
+        {
+            const size_type FAN_OUT = BASE + (i < EXTRA);
+            INode *inode = new INode(child_type);
+
+            for (size_type j = 0; j < FAN_OUT; ++j)
+            {
+                inode->children[j] = level[pos + j];
+                if (j)
+                    inode->keys[j - 1] = std::move(separators[pos + j]);
+                if (ChildType::INDEX == child_type)
+                    static_cast<INode *>(level[pos + j])->father = inode;
             }
+
+            inode->child_count = FAN_OUT;
+            inode->key_count = FAN_OUT - 1;
+
+            // inodes before i are already written, so compact in place
+            level[i] = inode;
+            if (i != pos)
+                separators[i] = std::move(separators[pos]);
+            pos += FAN_OUT;
         }
-        else // Degree != lnode->key_count, do not need split
-            if (child_idx)
-                inode->keys[child_idx - 1] = lnode->keys[0];
 
-        while (inode->father)
-            inode = inode->father;
+        level.resize(INODE_CNT);
+        separators.resize(INODE_CNT);
+        child_type = ChildType::INDEX;
+    }
+
+    root = static_cast<INode *>(level[0]);
+    ++version;
+}
+
+template <class KeyType, size_type Degree>
+size_type BPlusTree<KeyType, Degree>::locate_key(const LNode *lnode, const key_type &k)
+{
+    return lnode->fingerprints.locate(lnode->keys, lnode->key_count, k);
+}
+
+template <class KeyType, size_type Degree>
+template <class ForwardIt>
+typename BPlusTree<KeyType, Degree>::LNode *
+BPlusTree<KeyType, Degree>::build_leaves(ForwardIt first, ForwardIt last, std::vector<Node<key_type, Degree> *> &leaves,
+                                         size_type fill)
+{
+    size_type key_cnt = 0;
+
+    for (ForwardIt it = first, prev = first; it != last; prev = it++)
+        if (it == first || !(*it == *prev))
+            ++key_cnt;
+
+    leaves.clear();
+    if (!key_cnt)
+        return nullptr;
+
+    // spread keys evenly so that every leafnode keeps at least NODE_MIN_LEN keys
+    const size_type LEAF_CNT = (key_cnt + fill - 1) / fill;
+    const size_type BASE = key_cnt / LEAF_CNT, EXTRA = key_cnt % LEAF_CNT;
+    LNode *lnode = nullptr;
+
+    leaves.reserve(LEAF_CNT);
 
-        root = inode;
+    for (size_type i = 0; i < LEAF_CNT; ++i)
+    {
+        const size_type FILL = BASE + (i < EXTRA);
+        LNode *bro_lnode = new LNode;
+
+        while (bro_lnode->key_count < FILL)
+        {
+            bro_lnode->keys[bro_lnode->key_count++] = *first;
+            bro_lnode->fingerprints.insert(bro_lnode->keys, bro_lnode->key_count, bro_lnode->key_count - 1);
+
+            ForwardIt prev = first;
+            while (++first != last && *first == *prev)
+                ;
+        }
+
+        if (lnode)
+            lnode->next = bro_lnode;
+        lnode = bro_lnode;
+        leaves.push_back(bro_lnode);
     }
+
+    return static_cast<LNode *>(leaves[0]);
 }
 
 template <class KeyType, size_type Degree>
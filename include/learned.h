@@ -0,0 +1,457 @@
+#ifndef LEARNED_H
+#define LEARNED_H 1
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "bptree.h"
+
+/**
+ * Read-optimized variant of BPlusTree for integer keys: the indexnodes are replaced by a
+ * piecewise linear model over the first key of every leafnode. A segment is a gapped
+ * array of slots, each holding a separator and a leafnode pointer in two contiguous
+ * vectors, and a gap repeats the slot on its left. The model predicts the slot of k, an
+ * exponential search over the separators of the segment finishes the lookup. The leafnode
+ * chain is shared with BPlusTree.
+ *
+ * The greedy fit alone decides where a segment ends. A split takes a gap of its own
+ * segment, shifting at most REACH slots, and only a segment that runs out of nearby gaps
+ * or becomes too sparse is refitted. Bulk loading leaves a quarter of every leafnode free
+ * so that the first inserts do not split.
+ */
+template <class KeyType, size_type Degree, size_type Epsilon = 32>
+class LearnedBPlusTree : protected BPlusTree<KeyType, Degree>
+{
+    static_assert(std::is_integral<KeyType>::value, "KeyType must be integral");
+
+    typedef BPlusTree<KeyType, Degree> Base;
+
+    friend std::ostream &operator<<(std::ostream &os, const LearnedBPlusTree &lbt)
+    {
+        return os << static_cast<const Base &>(lbt);
+    }
+
+public:
+    typedef typename Base::key_type key_type;
+    typedef ::size_type size_type;
+
+protected:
+    typedef typename Base::LNode LNode;
+
+    struct Segment
+    {
+        double slope;                // slope * (k - first key of the segment) is the predicted slot of k
+        size_type leaf_count;        // slots that are not gaps
+        std::vector<key_type> keys;  // separator of every slot, ascending
+        std::vector<LNode *> leaves; // leafnode of every slot, consecutive leafnodes of the chain
+    };
+
+    static const size_type REACH = Epsilon > 16 ? Epsilon : 16; // most slots a split shifts before a refit
+
+public:
+    LearnedBPlusTree() = default;
+    LearnedBPlusTree(LearnedBPlusTree &&) noexcept = default;
+    LearnedBPlusTree &operator=(LearnedBPlusTree &&) noexcept;
+
+public:
+    bool find(const key_type &) const;
+    bool remove(const key_type &);
+    void clear() noexcept;
+    void insert(const key_type &);
+
+    // [first, last) must be ascending, equal keys are collapsed
+    template <class ForwardIt>
+    void bulk_load(ForwardIt, ForwardIt);
+
+    size_type segment_count() const noexcept { return segments.size(); }
+
+private:
+    size_type locate_segment(const key_type &) const;
+    size_type locate_slot(size_type, const key_type &) const;
+    static void locate_run(const Segment &, size_type, size_type &, size_type &);
+    static bool open_gap(Segment &, size_type &, size_type &, size_type);
+    void add_leaf(size_type, size_type, LNode *);
+    void drop_leaf(size_type, size_type);
+    static void fit(const key_type *, LNode *const *, size_type, std::vector<key_type> &, std::vector<Segment> &);
+    void refit(size_type);
+
+protected:
+    std::vector<key_type> first_keys; // lower bound of every segment, ascending
+    std::vector<Segment> segments;
+};
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+LearnedBPlusTree<KeyType, Degree, Epsilon> &
+LearnedBPlusTree<KeyType, Degree, Epsilon>::operator=(LearnedBPlusTree &&other) noexcept
+{
+    if (this != &other)
+    {
+        Base::operator=(std::move(other));
+        first_keys = std::move(other.first_keys);
+        segments = std::move(other.segments);
+        other.clear();
+    }
+    return *this;
+}
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+bool LearnedBPlusTree<KeyType, Degree, Epsilon>::find(const key_type &k) const
+{
+    if (segments.empty())
+        return false;
+
+    size_type seg_idx = locate_segment(k);
+    return size_type(-1) != Base::locate_key(segments[seg_idx].leaves[locate_slot(seg_idx, k)], k);
+}
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+bool LearnedBPlusTree<KeyType, Degree, Epsilon>::remove(const key_type &k)
+{
+    if (segments.empty())
+        return false;
+
+    size_type seg_idx = locate_segment(k), slot = locate_slot(seg_idx, k);
+    LNode *lnode = segments[seg_idx].leaves[slot];
+    size_type k_idx = Base::locate_key(lnode, k);
+
+    if (size_type(-1) == k_idx) // can not find k
+        return false;
+
+    remove_at(lnode->keys, lnode->key_count, k_idx);
+    lnode->fingerprints.remove(lnode->key_count, k_idx);
+
+    if (!lnode->key_count)
+        drop_leaf(seg_idx, slot);
+
+    return true;
+}
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::clear() noexcept
+{
+    Base::clear();
+    first_keys.clear();
+    segments.clear();
+}
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::insert(const key_type &k)
+{
+    if (segments.empty()) // there is no keys
+    {
+        LNode *lnode = new LNode;
+        lnode->keys[0] = k;
+        lnode->key_count = 1;
+        lnode->fingerprints.insert(lnode->keys, 1, 0);
+
+        this->data = lnode;
+        fit(lnode->keys, &lnode, 1, first_keys, segments);
+        return;
+    }
+
+    size_type seg_idx = locate_segment(k), slot = locate_slot(seg_idx, k);
+    LNode *lnode = segments[seg_idx].leaves[slot];
+    size_type pos = locate_insert(lnode->keys, lnode->key_count, k);
+
+    insert_at(lnode->keys, lnode->key_count, k, pos);
+    lnode->fingerprints.insert(lnode->keys, lnode->key_count, pos);
+
+    if (Degree == lnode->key_count) // need split
+    {
+        const size_type SPLIT_POS = Degree >> 1;
+        LNode *bro_lnode = new LNode; // right brother leafnode
+
+        bro_lnode->next = lnode->next;
+        bro_lnode->key_count = Degree - SPLIT_POS;
+        move_n(lnode->keys + SPLIT_POS, bro_lnode->key_count, bro_lnode->keys);
+        lnode->fingerprints.copy_to(SPLIT_POS, bro_lnode->key_count, bro_lnode->fingerprints, 0);
+
+        lnode->key_count = SPLIT_POS;
+        lnode->next = bro_lnode;
+
+        add_leaf(seg_idx, slot, bro_lnode);
+    }
+}
+
+template <class KeyType, size_type Degree, size_type Epsilon>
+template <class ForwardIt>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::bulk_load(ForwardIt first, ForwardIt last)
+{
+    std::vector<Node<key_type, Degree> *> level;
+
+    clear();
+    this->data = Base::build_leaves(first, last, level, std::max<size_type>(1, Degree - 1 - (Degree >> 2)));
+
+    if (level.empty())
+        return;
+
+    std::vector<key_type> keys(level.size());
+    std::vector<LNode *> leaves(level.size());
+    for (size_type i = 0; i < level.size(); ++i)
+    {
+        leaves[i] = static_cast<LNode *>(level[i]);
+        keys[i] = leaves[i]->keys[0];
+    }
+
+    fit(keys.data(), leaves.data(), leaves.size(), first_keys, segments);
+}
+
+// index of the last segment whose first key <= k, or 0, segments must not be empty
+template <class KeyType, size_type Degree, size_type Epsilon>
+inline size_type LearnedBPlusTree<KeyType, Degree, Epsilon>::locate_segment(const key_type &k) const
+{
+    typename std::vector<key_type>::const_iterator it = std::upper_bound(first_keys.begin(), first_keys.end(), k);
+    return it == first_keys.begin() ? 0 : it - first_keys.begin() - 1;
+}
+
+// index of the last slot of segments[seg_idx] whose separator <= k, or 0
+template <class KeyType, size_type Degree, size_type Epsilon>
+size_type LearnedBPlusTree<KeyType, Degree, Epsilon>::locate_slot(size_type seg_idx, const key_type &k) const
+{
+    const Segment &seg = segments[seg_idx];
+    const size_type SLOT_CNT = seg.keys.size();
+    const double PREDICT = seg.slope * (double(k) - double(first_keys[seg_idx]));
+    // clamp in double, a prediction beyond the range of size_type can not be converted
+    size_type lo = PREDICT <= 0 ? 0 : PREDICT >= double(SLOT_CNT - 1) ? SLOT_CNT - 1 : size_type(PREDICT), hi, step = 1;
+
+    // gallop away from the prediction until [lo, hi) brackets the answer, lo always qualifies
+    if (!lo || !(k < seg.keys[lo]))
+    {
+        while (lo + step < SLOT_CNT && !(k < seg.keys[lo + step]))
+        {
+            lo += step;
+            step <<= 1;
+        }
+        hi = std::min(SLOT_CNT, lo + step);
+    }
+    else
+    {
+        hi = lo;
+        while (hi > step && k < seg.keys[hi - step])
+        {
+            hi -= step;
+            step <<= 1;
+        }
+        lo = hi > step ? hi - step : 0;
+    }
+
+    while (hi - lo > 1)
+    {
+        size_type mid = lo + ((hi - lo) >> 1);
+
+        if (k < seg.keys[mid])
+            hi = mid;
+        else
+            lo = mid;
+    }
+
+    return lo;
+}
+
+// [begin, end) are the slots that hold the leafnode of slot
+template <class KeyType, size_type Degree, size_type Epsilon>
+inline void LearnedBPlusTree<KeyType, Degree, Epsilon>::locate_run(const Segment &seg, size_type slot, size_type &begin,
+                                                                   size_type &end)
+{
+    for (begin = slot; begin && seg.leaves[begin - 1] == seg.leaves[slot]; --begin)
+        ;
+    for (end = slot + 1; end < seg.leaves.size() && seg.leaves[end] == seg.leaves[slot]; ++end)
+        ;
+}
+
+// widen the one-slot run [begin, end) by shifting the slots up to the nearest gap within reach
+template <class KeyType, size_type Degree, size_type Epsilon>
+bool LearnedBPlusTree<KeyType, Degree, Epsilon>::open_gap(Segment &seg, size_type &begin, size_type &end,
+                                                          size_type reach)
+{
+    const size_type SLOT_CNT = seg.leaves.size();
+    size_type right = end, left = begin;
+
+    while (right < SLOT_CNT && right - end <= reach && seg.leaves[right] != seg.leaves[right - 1])
+        ++right;
+    while (left && begin - left <= reach && seg.leaves[left] != seg.leaves[left - 1])
+        --left;
+
+    const bool HAS_RIGHT = right < SLOT_CNT && right - end <= reach, HAS_LEFT = left && begin - left <= reach;
+
+    if (HAS_RIGHT && (!HAS_LEFT || right - end <= begin - left))
+    {
+        std::copy_backward(seg.keys.begin() + end, seg.keys.begin() + right, seg.keys.begin() + right + 1);
+        std::copy_backward(seg.leaves.begin() + end, seg.leaves.begin() + right, seg.leaves.begin() + right + 1);
+        seg.keys[end] = seg.keys[begin];
+        seg.leaves[end++] = seg.leaves[begin];
+    }
+    else if (HAS_LEFT) // the gap at left is overwritten, slot begin keeps its leafnode
+    {
+        std::copy(seg.keys.begin() + left + 1, seg.keys.begin() + end, seg.keys.begin() + left);
+        std::copy(seg.leaves.begin() + left + 1, seg.leaves.begin() + end, seg.leaves.begin() + left);
+        --begin;
+    }
+    else
+        return false;
+
+    return true;
+}
+
+// bro_lnode was split off the leafnode of segments[seg_idx] at slot, give it the upper half of its run
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::add_leaf(size_type seg_idx, size_type slot, LNode *bro_lnode)
+{
+    size_type begin, end;
+
+    locate_run(segments[seg_idx], slot, begin, end);
+
+    if (end - begin == 1 && !open_gap(segments[seg_idx], begin, end, REACH))
+    {
+        // bro_lnode is not indexed yet, so its first key still leads to the leafnode it came from
+        refit(seg_idx);
+        seg_idx = locate_segment(bro_lnode->keys[0]);
+        locate_run(segments[seg_idx], locate_slot(seg_idx, bro_lnode->keys[0]), begin, end);
+
+        if (end - begin == 1) // a fresh fit always has a gap, maybe not within REACH
+            open_gap(segments[seg_idx], begin, end, segments[seg_idx].leaves.size());
+    }
+
+    Segment &seg = segments[seg_idx];
+    const size_type MID = begin + ((end - begin) >> 1);
+
+    // slot 0 also takes keys below its separator, which may now have moved to bro_lnode
+    if (!begin && bro_lnode->keys[0] < seg.keys[0])
+        std::fill(seg.keys.begin(), seg.keys.begin() + MID, bro_lnode->keys[0]);
+    std::fill(seg.keys.begin() + MID, seg.keys.begin() + end, bro_lnode->keys[0]);
+    std::fill(seg.leaves.begin() + MID, seg.leaves.begin() + end, bro_lnode);
+    ++seg.leaf_count;
+}
+
+// unlink and free the empty leafnode of segments[seg_idx] at slot, its slots become gaps of a neighbour
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::drop_leaf(size_type seg_idx, size_type slot)
+{
+    Segment &seg = segments[seg_idx];
+    LNode *lnode = seg.leaves[slot];
+    size_type begin, end;
+
+    locate_run(seg, slot, begin, end);
+
+    if (begin)
+        seg.leaves[begin - 1]->next = lnode->next;
+    else if (seg_idx)
+        segments[seg_idx - 1].leaves.back()->next = lnode->next;
+    else
+        this->data = lnode->next;
+
+    delete lnode;
+
+    if (!--seg.leaf_count)
+    {
+        if (segments.size() > 1)
+        {
+            first_keys.erase(first_keys.begin() + seg_idx);
+            segments.erase(segments.begin() + seg_idx);
+        }
+        else
+            clear();
+        return;
+    }
+
+    // slot 0 has no left neighbour, its run goes to the right one and keeps the first key of the segment
+    const size_type SRC = begin ? begin - 1 : end;
+    std::fill(seg.keys.begin() + begin, seg.keys.begin() + end, seg.keys[SRC]);
+    std::fill(seg.leaves.begin() + begin, seg.leaves.begin() + end, seg.leaves[SRC]);
+
+    if (seg.leaf_count * 2 < seg.leaves.size()) // too sparse
+        refit(seg_idx);
+}
+
+// greedy shrinking cone: extend a segment while one slope keeps every leafnode within Epsilon of its
+// gapped position, then place the leafnodes where the slope predicts them
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::fit(const key_type *keys, LNode *const *leaves, size_type leaf_cnt,
+                                                     std::vector<key_type> &first_keys, std::vector<Segment> &out)
+{
+    size_type i = 0;
+
+    while (i < leaf_cnt)
+    {
+        const size_type START = i;
+        const double X0 = double(keys[START]);
+        double slope_lo = 0, slope_hi = -1; // slope_hi < 0 means unbounded
+
+        for (++i; i < leaf_cnt; ++i)
+        {
+            const double DX = double(keys[i]) - X0, DY = double((i - START) + ((i - START) >> 3));
+            if (DX <= 0) // only equal keys split across leafnodes can repeat a first key
+                break;
+
+            double lo = std::max(slope_lo, (DY - Epsilon) / DX), hi = (DY + Epsilon) / DX;
+
+            if (slope_hi >= 0)
+                hi = std::min(slope_hi, hi);
+            if (lo > hi)
+                break;
+
+            slope_lo = lo;
+            slope_hi = hi;
+        }
+
+        // one gap after every 8 leafnodes and one at the end
+        const size_type LEAF_CNT = i - START, SLOT_CNT = LEAF_CNT + 1 + ((LEAF_CNT - 1) >> 3);
+
+        first_keys.push_back(keys[START]);
+        out.push_back(Segment());
+
+        Segment &seg = out.back();
+        seg.slope = slope_hi < 0 ? 0 : (slope_lo + slope_hi) / 2;
+        seg.leaf_count = LEAF_CNT;
+        seg.keys.resize(SLOT_CNT);
+        seg.leaves.resize(SLOT_CNT);
+
+        for (size_type j = 0, slot = 0; j < LEAF_CNT; ++j)
+        {
+            size_type next = SLOT_CNT;
+
+            if (j + 1 < LEAF_CNT) // leave one slot for every later leafnode
+            {
+                const double PREDICT = seg.slope * (double(keys[START + j + 1]) - X0);
+                const size_type LO = slot + 1, HI = SLOT_CNT - (LEAF_CNT - j - 1);
+                next = PREDICT <= double(LO) ? LO : PREDICT >= double(HI) ? HI : size_type(PREDICT);
+            }
+
+            std::fill(seg.keys.begin() + slot, seg.keys.begin() + next, keys[START + j]);
+            std::fill(seg.leaves.begin() + slot, seg.leaves.begin() + next, leaves[START + j]);
+            slot = next;
+        }
+    }
+}
+
+// replace segments[seg_idx] with a fresh fit of its leafnodes, the first one keeps the lower bound of the segment
+template <class KeyType, size_type Degree, size_type Epsilon>
+void LearnedBPlusTree<KeyType, Degree, Epsilon>::refit(size_type seg_idx)
+{
+    const Segment &seg = segments[seg_idx];
+    std::vector<key_type> keys, fitted_keys;
+    std::vector<LNode *> leaves;
+    std::vector<Segment> fitted;
+
+    keys.reserve(seg.leaf_count);
+    leaves.reserve(seg.leaf_count);
+
+    for (size_type i = 0; i < seg.leaves.size(); ++i)
+        if (!i || seg.leaves[i] != seg.leaves[i - 1])
+        {
+            keys.push_back(seg.keys[i]);
+            leaves.push_back(seg.leaves[i]);
+        }
+
+    if (seg_idx) // the first segment routes every smaller key anyway, its slot 0 may have gone below
+        keys[0] = first_keys[seg_idx];
+    fit(keys.data(), leaves.data(), leaves.size(), fitted_keys, fitted);
+
+    first_keys[seg_idx] = fitted_keys[0];
+    segments[seg_idx] = std::move(fitted[0]);
+    first_keys.insert(first_keys.begin() + seg_idx + 1, fitted_keys.begin() + 1, fitted_keys.end());
+    segments.insert(segments.begin() + seg_idx + 1,
+                    std::make_move_iterator(fitted.begin() + 1), std::make_move_iterator(fitted.end()));
+}
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef LOADER_H
+#define LOADER_H 1
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bptree.h"
+
+/**
+ * TEXT:   decimal integers separated by whitespace, e.g. the output of scripts/gen_data.sh
+ * BINARY: fixed-width native-endian KeyType records, no header
+ */
+enum struct KeyFormat : bool
+{
+    TEXT,
+    BINARY
+};
+
+// read-only private mapping of a whole file
+class MappedFile
+{
+public:
+    explicit MappedFile(const char *);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+public:
+    const char *data() const noexcept { return addr; }
+    size_type size() const noexcept { return len; }
+
+private:
+    char *addr = nullptr;
+    size_type len = 0;
+};
+
+inline MappedFile::MappedFile(const char *path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (-1 == fd)
+        throw std::system_error(errno, std::generic_category(), std::string("unable to open ") + path);
+
+    struct stat st;
+    if (-1 == ::fstat(fd, &st))
+    {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), std::string("unable to stat ") + path);
+    }
+
+    if (!S_ISREG(st.st_mode)) // pipes and devices report no usable size
+    {
+        ::close(fd);
+        throw std::system_error(EINVAL, std::generic_category(), std::string("not a regular file: ") + path);
+    }
+
+    len = st.st_size;
+
+    if (len) // mmap rejects empty mappings
+    {
+        void *p = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == p)
+        {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), std::string("unable to map ") + path);
+        }
+
+        addr = static_cast<char *>(p);
+        ::madvise(addr, len, MADV_SEQUENTIAL); // advice values are not flags
+        ::madvise(addr, len, MADV_WILLNEED);
+    }
+
+    ::close(fd);
+}
+
+inline MappedFile::~MappedFile()
+{
+    if (addr)
+        ::munmap(addr, len);
+}
+
+namespace detail
+{
+    inline unsigned loader_threads(unsigned threads, size_type bytes)
+    {
+        const size_type MIN_CHUNK = size_type(1) << 20; // smaller chunks are not worth a thread
+
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        return unsigned(std::max<size_type>(1, std::min<size_type>(threads, bytes / MIN_CHUNK)));
+    }
+
+    inline bool is_space(char c)
+    {
+        return ' ' == c || '\n' == c || '\r' == c || '\t' == c || '\v' == c || '\f' == c;
+    }
+
+    inline bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // SWAR: test and convert 8 ASCII digits held in one little-endian word
+    inline bool is_eight_digits(std::uint64_t v)
+    {
+        return !(((v + 0x4646464646464646ull) | (v - 0x3030303030303030ull)) & 0x8080808080808080ull);
+    }
+
+    inline std::uint32_t parse_eight_digits(std::uint64_t v)
+    {
+        const std::uint64_t MASK = 0x000000FF000000FFull;
+        const std::uint64_t MUL1 = 0x000F424000000064ull; // 100 + (1000000 << 32)
+        const std::uint64_t MUL2 = 0x0000271000000001ull; // 1 + (10000 << 32)
+
+        v -= 0x3030303030303030ull;
+        v = v * 10 + (v >> 8);
+        v = ((v & MASK) * MUL1 + ((v >> 16) & MASK) * MUL2) >> 32;
+
+        return std::uint32_t(v);
+    }
+#endif
+
+    // parse the whitespace separated integers of [first, last), base is the offset used in error messages
+    template <class KeyType>
+    void parse_chunk(const char *first, const char *last, size_type base, std::vector<KeyType> &out)
+    {
+        typedef typename std::make_unsigned<KeyType>::type unsigned_type;
+        const char *p = first;
+
+        out.reserve(out.size() + (last - first) / 8);
+
+        while (true)
+        {
+            while (p != last && is_space(*p))
+                ++p;
+            if (p == last)
+                break;
+
+            const char *token = p;
+            bool negative = false;
+
+            if ('-' == *p || '+' == *p)
+                negative = '-' == *p++;
+
+            const char *digits = p;
+            std::uint64_t value = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::uint64_t word;
+            while (last - p >= 8 && p - digits < 16 && (std::memcpy(&word, p, 8), is_eight_digits(word)))
+            {
+                value = value * 100000000u + parse_eight_digits(word);
+                p += 8;
+            }
+#endif
+            bool overflow = false;
+            while (p != last && is_digit(*p))
+            {
+                const unsigned d = *p++ - '0';
+                overflow = overflow || value > (std::numeric_limits<std::uint64_t>::max() - d) / 10;
+                value = value * 10 + d;
+            }
+
+            if (p == digits || (p != last && !is_space(*p)))
+                throw std::invalid_argument("invalid key at offset " + std::to_string(base + (token - first)));
+
+            std::uint64_t limit = std::numeric_limits<KeyType>::max();
+            if (negative) // magnitude of min()
+                limit = std::is_signed<KeyType>::value ? limit + 1 : 0;
+
+            if (overflow || value > limit)
+                throw std::out_of_range("key out of range at offset " + std::to_string(base + (token - first)));
+
+            out.push_back(negative ? KeyType(unsigned_type(0) - unsigned_type(value)) : KeyType(value));
+        }
+    }
+
+    // run fn(i) on threads workers and rethrow the first failure
+    template <class Fn>
+    void parallel_for(unsigned threads, Fn fn)
+    {
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors(threads);
+
+        for (unsigned i = 1; i < threads; ++i)
+            workers.emplace_back([&fn, &errors, i]() {
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+
+        try
+        {
+            fn(0);
+        }
+        catch (...)
+        {
+            errors[0] = std::current_exception();
+        }
+
+        for (size_type i = 0; i < workers.size(); ++i)
+            workers[i].join();
+
+        for (unsigned i = 0; i < threads; ++i)
+            if (errors[i])
+                std::rethrow_exception(errors[i]);
+    }
+
+    // sort keys with one run per thread followed by pairwise merge rounds
+    template <class KeyType>
+    void parallel_sort(std::vector<KeyType> &keys, unsigned threads)
+    {
+        if (std::is_sorted(keys.begin(), keys.end()))
+            return;
+
+        std::vector<size_type> bounds(threads + 1);
+        for (unsigned i = 0; i <= threads; ++i)
+            bounds[i] = keys.size() * i / threads;
+
+        parallel_for(threads, [&](unsigned i) {
+            std::sort(keys.begin() + bounds[i], keys.begin() + bounds[i + 1]);
+        });
+
+        for (unsigned width = 1; width < threads; width <<= 1)
+        {
+            const unsigned MERGES = (threads + 2 * width - 1) / (2 * width);
+
+            parallel_for(MERGES, [&](unsigned i) {
+                const unsigned lo = 2 * width * i;
+                const unsigned mid = std::min(lo + width, threads), hi = std::min(lo + 2 * width, threads);
+
+                if (mid < hi)
+                    std::inplace_merge(keys.begin() + bounds[lo], keys.begin() + bounds[mid], keys.begin() + bounds[hi]);
+            });
+        }
+    }
+}
+
+/**
+ * parse buf into ascending keys using threads workers, 0 means one per hardware thread
+ * throws std::invalid_argument / std::out_of_range like std::stoi on malformed input
+ */
+template <class KeyType>
+std::vector<KeyType> parse_keys(const char *buf, size_type len, KeyFormat fmt, unsigned threads = 0)
+{
+    static_assert(std::is_integral<KeyType>::value, "KeyType must be integral");
+
+    std::vector<KeyType> keys;
+    threads = detail::loader_threads(threads, len);
+
+    if (KeyFormat::BINARY == fmt)
+    {
+        if (len % sizeof(KeyType))
+            throw std::invalid_argument("binary key file size is not a multiple of " + std::to_string(sizeof(KeyType)));
+
+        keys.resize(len / sizeof(KeyType));
+        if (len)
+            std::memcpy(keys.data(), buf, len);
+    }
+    else
+    {
+        // cut at whitespace so that no key straddles two chunks
+        std::vector<size_type> bounds(threads + 1);
+        std::vector<std::vector<KeyType>> parts(threads);
+
+        bounds[threads] = len;
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            size_type pos = std::max(bounds[i - 1], len * i / threads);
+            while (pos < len && !detail::is_space(buf[pos - 1]))
+                ++pos;
+            bounds[i] = pos;
+        }
+
+        detail::parallel_for(threads, [&](unsigned i) {
+            detail::parse_chunk(buf + bounds[i], buf + bounds[i + 1], bounds[i], parts[i]);
+        });
+
+        size_type total = 0;
+        for (unsigned i = 0; i < threads; ++i)
+            total += parts[i].size();
+
+        keys.reserve(total);
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            keys.insert(keys.end(), parts[i].begin(), parts[i].end());
+            std::vector<KeyType>().swap(parts[i]);
+        }
+    }
+
+    detail::parallel_sort(keys, threads);
+    return keys;
+}
+
+// replace the content of bpt with the keys stored in path
+template <class KeyType, size_type Degree>
+void load_file(BPlusTree<KeyType, Degree> &bpt, const char *path, KeyFormat fmt, unsigned threads = 0)
+{
+    std::vector<KeyType> keys;
+
+    {
+        MappedFile file(path);
+        keys = parse_keys<KeyType>(file.data(), file.size(), fmt, threads);
+    }
+
+    bpt.bulk_load(keys.begin(), keys.end());
+}
+
+#endif
@@ -1,8 +1,10 @@
 #ifndef NODE_H
 #define NODE_H 1
 
+#include <cstring>
 #include <ostream>
 #include "def.h"
+#include "utils.h"
 
 enum struct ChildType : bool
 {
@@ -28,9 +30,64 @@ struct IndexNode : Node<KeyType, MaxKeys>
     IndexNode *father = nullptr;
 };
 
+// fps[i] == fingerprint(keys[i]) for the keys of one leafnode, len is the key count after each change
+template <class KeyType, size_type MaxKeys, bool = use_fingerprints<KeyType>::value>
+struct Fingerprints
+{
+    // keys[pos] has just been inserted
+    void insert(const KeyType *keys, size_type len, size_type pos)
+    {
+        --len;
+        insert_at(fps, len, fingerprint(keys[pos]), pos);
+    }
+
+    // the key at pos has just been removed
+    void remove(size_type len, size_type pos)
+    {
+        ++len;
+        remove_at(fps, len, pos);
+    }
+
+    // copy the fingerprints of [pos, pos + n) to dst from dst_pos on
+    void copy_to(size_type pos, size_type n, Fingerprints &dst, size_type dst_pos) const
+    {
+        std::memcpy(dst.fps + dst_pos, fps + pos, n);
+    }
+
+    // index of k in keys[0, len), -1 if there is none
+    size_type locate(const KeyType *keys, size_type len, const KeyType &k) const
+    {
+        const unsigned char FP = fingerprint(k);
+
+        // only slots whose fingerprint matches need a full key comparison
+        for (size_type i = locate_fingerprint(fps, 0, len, FP); i < len; i = locate_fingerprint(fps, i + 1, len, FP))
+            if (k == keys[i])
+                return i;
+
+        return -1; // can not find
+    }
+
+    unsigned char fps[MaxKeys];
+};
+
+// fingerprints are off: nothing is stored and lookups compare every key
+template <class KeyType, size_type MaxKeys>
+struct Fingerprints<KeyType, MaxKeys, false>
+{
+    void insert(const KeyType *, size_type, size_type) {}
+    void remove(size_type, size_type) {}
+    void copy_to(size_type, size_type, Fingerprints &, size_type) const {}
+
+    size_type locate(const KeyType *keys, size_type len, const KeyType &k) const
+    {
+        return locate_value(keys, len, k);
+    }
+};
+
 template <class KeyType, size_type MaxKeys>
 struct LeafNode : Node<KeyType, MaxKeys>
 {
+    Fingerprints<KeyType, MaxKeys> fingerprints;
     LeafNode *next = nullptr;
 };
 
@@ -53,13 +110,13 @@ std::ostream &operator<<(std::ostream &os, const Node<KeyType, MaxKeys> &node)
 template <class KeyType, size_type MaxKeys>
 inline std::ostream &operator<<(std::ostream &os, const IndexNode<KeyType, MaxKeys> &inode)
 {
-    return os << static_cast<Node<KeyType, MaxKeys>>(inode);
+    return os << static_cast<const Node<KeyType, MaxKeys> &>(inode);
 }
 
 template <class KeyType, size_type MaxKeys>
 inline std::ostream &operator<<(std::ostream &os, const LeafNode<KeyType, MaxKeys> &lnode)
 {
-    return os << static_cast<Node<KeyType, MaxKeys>>(lnode);
+    return os << static_cast<const Node<KeyType, MaxKeys> &>(lnode);
 }
 
 #endif
@@ -1,8 +1,17 @@
 #ifndef UTILS_H
-#define UITLS_H 1
+#define UTILS_H 1
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
 #include "def.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /**
  * T must overload operator== and operator<=
  * arr is ascending ordered
@@ -18,6 +27,42 @@ size_type locate_value(const T *arr, size_type len, const T &value)
     return -1; // can not find
 }
 
+// specialize as std::true_type to keep per-key fingerprints in the leafnodes, T must then be hashable by std::hash
+template <class T>
+struct use_fingerprints : std::false_type
+{
+};
+
+// one-byte summary of value, equal values always share a fingerprint
+template <class T>
+inline unsigned char fingerprint(const T &value)
+{
+    unsigned long long h = std::hash<T>()(value);
+    return static_cast<unsigned char>((h * 0x9E3779B97F4A7C15ull) >> 56);
+}
+
+// first i in [pos, len) with fps[i] == fp, len if there is none
+inline size_type locate_fingerprint(const unsigned char *fps, size_type pos, size_type len, unsigned char fp)
+{
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(fp));
+
+    for (; pos + 16 <= len; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fps + pos));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+#endif
+    for (; pos < len; ++pos)
+        if (fp == fps[pos])
+            return pos;
+
+    return len;
+}
+
 template <class T>
 size_type locate_insert(const T *arr, size_type len, const T &value)
 {
@@ -29,17 +74,74 @@ size_type locate_insert(const T *arr, size_type len, const T &value)
     return pos;
 }
 
+/**
+ * element moves are dispatched on std::is_trivially_copyable:
+ * trivial types are moved as raw bytes, the others by move assignment
+ */
+
+// move arr[pos, len) to arr[pos + 1, len + 1)
 template <class T>
-void insert_at(T *arr, size_type &len, const T &value, size_type pos)
+inline void shift_right(T *arr, size_type len, size_type pos, std::true_type)
 {
-    for (size_type i = len; i > pos; --i)
-        arr[i] = arr[i - 1];
+    std::memmove(arr + pos + 1, arr + pos, sizeof(T) * (len - pos));
+}
 
+template <class T>
+inline void shift_right(T *arr, size_type len, size_type pos, std::false_type)
+{
+    std::move_backward(arr + pos, arr + len, arr + len + 1);
+}
+
+// move arr[pos + 1, len) to arr[pos, len - 1)
+template <class T>
+inline void shift_left(T *arr, size_type len, size_type pos, std::true_type)
+{
+    std::memmove(arr + pos, arr + pos + 1, sizeof(T) * (len - pos - 1));
+}
+
+template <class T>
+inline void shift_left(T *arr, size_type len, size_type pos, std::false_type)
+{
+    std::move(arr + pos + 1, arr + len, arr + pos);
+}
+
+// move src[0, n) to dst[0, n), the ranges must not overlap
+template <class T>
+inline void move_n(T *src, size_type n, T *dst, std::true_type)
+{
+    std::memcpy(dst, src, sizeof(T) * n);
+}
+
+template <class T>
+inline void move_n(T *src, size_type n, T *dst, std::false_type)
+{
+    std::move(src, src + n, dst);
+}
+
+template <class T>
+inline void move_n(T *src, size_type n, T *dst)
+{
+    move_n(src, n, dst, typename std::is_trivially_copyable<T>::type());
+}
+
+template <class T>
+void insert_at(T *arr, size_type &len, const T &value, size_type pos)
+{
+    shift_right(arr, len, pos, typename std::is_trivially_copyable<T>::type());
     arr[pos] = value;
 
     ++len;
 }
 
+template <class T>
+void insert_at(T *arr, size_type &len, T &&value, size_type pos)
+{
+    shift_right(arr, len, pos, typename std::is_trivially_copyable<T>::type());
+    arr[pos] = std::move(value);
+
+    ++len;
+}
+
 template <class T>
 inline void insert_value(T *arr, size_type &len, const T &value)
 {
@@ -49,8 +151,7 @@ inline void insert_value(T *arr, size_type &len, const T &value)
 template <class T>
 void remove_at(T *arr, size_type &len, size_type pos)
 {
-    for (size_type i = pos + 1; i < len; ++i)
-        arr[i - 1] = arr[i];
+    shift_left(arr, len, pos, typename std::is_trivially_copyable<T>::type());
 
     --len;
 }
@@ -61,10 +162,7 @@ bool remove_value(T *arr, size_type &len, const T &value)
     size_type pos = locate_value(arr, len, value);
     if (size_type(-1) != pos)
     {
-        for (size_type i = pos + 1; i < len; ++i)
-            arr[i - 1] = arr[i];
-
-        --len;
+        remove_at(arr, len, pos);
         return true;
     }
     else
@@ -2,29 +2,21 @@
 
 # Check if an output path was provided as the first argument
 if [ -z "$1" ]; then
-    echo "Usage: $0 <output_path>"
+    echo "Usage: $0 <output_path> [count]"
     exit 1
 fi
 
-# Specify the range and quantity of random numbers to generate
-min=1
-max=100
-count=10
+# Thin wrapper over the native generator, see `bptree-gen` without arguments for every option
+gen=${BPTREE_GEN:-$(dirname "$0")/../build/bptree-gen}
 
-# Specify the file to save the random numbers
-output_file=$1
-
-# Clear or create the file
-> "$output_file"
+if [ ! -x "$gen" ]; then
+    echo "$gen not found, build the project or set BPTREE_GEN"
+    exit 1
+fi
 
-# Generate unique random numbers and write them to the file
-while [ $(wc -l < "$output_file") -lt $count ]; do
-    random_number=$((min + RANDOM % (max - min + 1)))
+output_file=$1
+count=${2:-10}
 
-    # Check if the random number already exists in the file
-    if ! grep -q "$random_number" "$output_file"; then
-        echo "$random_number" >> "$output_file"
-    fi
-done
+"$gen" --count "$count" "$output_file" || exit 1
 
 echo "Generated unique random numbers have been saved to the file $output_file."
@@ -0,0 +1,69 @@
+#ifndef CHECK_H
+#define CHECK_H 1
+
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+
+// helpers shared by the test drivers, a failed check reports to std::cerr and returns false
+
+template <class Tree>
+std::string dump(const Tree &tree)
+{
+    std::ostringstream os;
+    os << tree;
+    return os.str();
+}
+
+// tree finds exactly the keys of model within [lo, hi)
+template <class Tree>
+bool check_keys(const Tree &tree, const std::set<long long> &model, long long lo, long long hi, const std::string &name)
+{
+    for (long long k = lo; k < hi; ++k)
+        if (tree.find(k) != (model.count(k) > 0))
+        {
+            std::cerr << name << ": find " << k << " disagrees\n";
+            return false;
+        }
+
+    return true;
+}
+
+// random inserts, removes and finds of keys in [lo, hi), mirrored on model
+template <class Tree>
+bool check_ops(Tree &tree, std::set<long long> &model, long long lo, long long hi, int ops, unsigned seed,
+               const std::string &name)
+{
+    std::mt19937 rng(seed);
+
+    for (int i = 0; i < ops; ++i)
+    {
+        long long k = lo + (long long)(rng() % (unsigned long long)(hi - lo));
+        bool ok = true;
+
+        switch (rng() % 3)
+        {
+        case 0:
+            if (model.insert(k).second) // keys stay unique
+                tree.insert(k);
+            break;
+        case 1:
+            ok = tree.remove(k) == (model.erase(k) > 0);
+            break;
+        default:
+            ok = tree.find(k) == (model.count(k) > 0);
+        }
+
+        if (!ok)
+        {
+            std::cerr << name << ": key " << k << " disagrees at op " << i << ", seed " << seed << '\n';
+            return false;
+        }
+    }
+
+    return check_keys(tree, model, lo - 1, hi + 1, name);
+}
+
+#endif
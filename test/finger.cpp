@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include "bptree.h"
+#include "check.h"
+
+// the same workload through finger and plain calls must give the same answers and the same tree
+template <size_type Degree>
+static bool check_finger(unsigned seed, bool clustered)
+{
+    typedef BPlusTree<long long, Degree> Tree;
+
+    const long long RANGE = 1500;
+    std::mt19937 rng(seed);
+    Tree fingered, plain;
+    typename Tree::Finger finger;
+    std::set<long long> keys;
+    long long cur = 0;
+
+    for (int i = 0; i < 6000; ++i)
+    {
+        if (clustered) // small steps around the previous key
+            cur = (cur + RANGE + (long long)(rng() % 7) - 3) % RANGE;
+
+        long long k = clustered ? cur : (long long)(rng() % RANGE);
+        bool expect = keys.count(k) > 0;
+
+        if (fingered.find(finger, k) != expect || plain.find(k) != expect)
+        {
+            std::cerr << "finger: find " << k << " disagrees, Degree " << Degree << " seed " << seed << '\n';
+            return false;
+        }
+
+        if (!expect && rng() % 2) // keys stay unique
+        {
+            switch (i % 3)
+            {
+            case 0:
+                fingered.insert(finger, k);
+                break;
+            case 1:
+            {
+                long long tmp = k;
+                fingered.insert(finger, std::move(tmp));
+                break;
+            }
+            default:
+                fingered.emplace_hint(finger, k);
+            }
+            plain.insert(k);
+            keys.insert(k);
+
+            if (dump(fingered) != dump(plain))
+            {
+                std::cerr << "finger: insert " << k << " diverges, Degree " << Degree << " seed " << seed << '\n';
+                return false;
+            }
+        }
+    }
+
+    // drain in key order, every leafnode underflows and borrows or merges on the way
+    std::vector<long long> order(keys.begin(), keys.end());
+    if (seed & 1)
+        order.assign(keys.rbegin(), keys.rend());
+
+    for (size_type i = 0; i < order.size(); ++i)
+        if (!fingered.remove(finger, order[i]) || !plain.remove(order[i]) || dump(fingered) != dump(plain))
+        {
+            std::cerr << "finger: remove " << order[i] << " diverges, Degree " << Degree << " seed " << seed << '\n';
+            return false;
+        }
+
+    return !fingered.find(finger, order.empty() ? 0 : order[0]) && dump(fingered) == dump(plain);
+}
+
+int main()
+{
+    bool ok = true;
+
+    for (unsigned seed = 0; seed < 4; ++seed)
+        for (int clustered = 0; clustered < 2; ++clustered)
+            ok = check_finger<3>(seed, clustered) && check_finger<4>(seed, clustered) &&
+                 check_finger<5>(seed, clustered) && check_finger<16>(seed, clustered) && ok;
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include "bptree.h"
+#include "check.h"
+
+// long long keys take the hashed leaf lookup in this driver only
+template <>
+struct use_fingerprints<long long> : std::true_type
+{
+};
+
+// exposes the leafnode chain to compare every stored fingerprint with a fresh hash
+template <size_type Degree>
+struct CheckedTree : BPlusTree<long long, Degree>
+{
+    bool fingerprints_match() const
+    {
+        for (const LeafNode<long long, Degree> *lnode = this->data; lnode; lnode = lnode->next)
+            for (size_type i = 0; i < lnode->key_count; ++i)
+                if (lnode->fingerprints.fps[i] != fingerprint(lnode->keys[i]))
+                    return false;
+
+        return true;
+    }
+};
+
+template <size_type Degree>
+static bool check_fingerprints(unsigned seed)
+{
+    const std::string NAME = "fingerprint Degree " + std::to_string(Degree);
+    CheckedTree<Degree> tree;
+    std::set<long long> model;
+
+    // a few rounds so that splits, borrows and merges all run between the checks
+    for (unsigned round = 0; round < 4; ++round)
+        if (!check_ops(tree, model, -2000, 2000, 5000, seed * 4 + round, NAME) || !tree.fingerprints_match())
+        {
+            std::cerr << NAME << ": stale fingerprints after round " << round << ", seed " << seed << '\n';
+            return false;
+        }
+
+    std::set<long long> loaded;
+    for (long long k = 0; k < 3000; k += 2)
+        loaded.insert(k);
+    tree.bulk_load(loaded.begin(), loaded.end());
+
+    return check_ops(tree, loaded, -10, 3010, 5000, seed, NAME) && tree.fingerprints_match();
+}
+
+int main()
+{
+    bool ok = true;
+
+    for (unsigned seed = 0; seed < 3; ++seed)
+        ok = check_fingerprints<3>(seed) && check_fingerprints<4>(seed) && check_fingerprints<16>(seed) &&
+             check_fingerprints<64>(seed) && ok;
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
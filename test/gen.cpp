@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "loader.h"
+
+static std::string gen; // path of bptree-gen
+
+static bool run(const std::string &args)
+{
+    return 0 == std::system(("\"" + gen + "\" " + args + " 2>/dev/null").c_str());
+}
+
+static std::vector<long long> read_keys(const char *path, KeyFormat fmt)
+{
+    MappedFile file(path);
+    return parse_keys<long long>(file.data(), file.size(), fmt);
+}
+
+// every distribution writes count distinct keys, and traced inserts never reuse one
+static bool check_unique(const std::string &dist, const std::string &extra)
+{
+    const std::uint64_t COUNT = 20000, OPS = 5000;
+    const std::string ARGS = "--dist " + dist + " --count " + std::to_string(COUNT) + " " + extra;
+    bool ok = true;
+
+    for (int binary = 0; binary < 2; ++binary)
+    {
+        if (!run(ARGS + (binary ? " --binary" : "") + " --ops " + std::to_string(OPS) +
+                 " --trace gen-test.trace gen-test.keys"))
+        {
+            std::cerr << "gen: " << ARGS << " failed\n";
+            return false;
+        }
+
+        std::vector<long long> keys = read_keys("gen-test.keys", binary ? KeyFormat::BINARY : KeyFormat::TEXT);
+
+        if (keys.size() != COUNT || keys.end() != std::adjacent_find(keys.begin(), keys.end()))
+        {
+            std::cerr << "gen: " << ARGS << (binary ? " --binary" : "") << " wrote duplicate or missing keys\n";
+            ok = false;
+        }
+    }
+
+    // text trace of the last run: "i <key>" must be a key seen nowhere before
+    std::set<long long> seen;
+    std::vector<long long> keys = read_keys("gen-test.keys", KeyFormat::BINARY);
+    seen.insert(keys.begin(), keys.end());
+
+    run(ARGS + " --ops " + std::to_string(OPS) + " --trace gen-test.trace gen-test.keys");
+    std::ifstream trace("gen-test.trace");
+    char op;
+    long long key;
+    std::string rest;
+
+    while (trace >> op >> key && std::getline(trace, rest))
+        if ('i' == op && !seen.insert(key).second)
+        {
+            std::cerr << "gen: " << ARGS << " traces an insert of existing key " << key << '\n';
+            return false;
+        }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <bptree-gen>\n";
+        std::exit(EXIT_FAILURE);
+    }
+    gen = argv[1];
+
+    bool ok = true;
+    const char *const DISTS[] = {"uniform", "sorted", "reverse", "zipfian", "clustered", "timestamp"};
+
+    for (const char *dist : DISTS)
+        ok = check_unique(dist, "--seed 3") && ok;
+    ok = check_unique("zipfian", "--skew 0.2 --gap 2") && check_unique("zipfian", "--skew 4 --gap 1") && ok;
+    ok = check_unique("clustered", "--cluster 7 --gap 3") && check_unique("uniform", "--base -100 --gap 1") && ok;
+
+    // wrapped or oversized ranges are refused up front
+    const char *const REFUSED[] = {"--count -5", "--count 10 --ops -1 --trace gen-test.trace",
+                                   "--count 5 --gap 4000000000000000000", "--count 10 --threads -1"};
+    for (const char *args : REFUSED)
+        if (run(std::string(args) + " gen-test.keys"))
+        {
+            std::cerr << "gen: " << args << " was accepted\n";
+            ok = false;
+        }
+
+    std::remove("gen-test.keys");
+    std::remove("gen-test.trace");
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
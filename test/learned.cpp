@@ -0,0 +1,154 @@
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "learned.h"
+
+// exposes the segments to check them against the leafnode chain
+template <size_type Degree, size_type Epsilon>
+struct CheckedTree : LearnedBPlusTree<long long, Degree, Epsilon>
+{
+    typedef LeafNode<long long, Degree> LNode;
+
+    // every leafnode of the chain owns one run of slots in chain order, separators bound its keys from below
+    bool consistent() const
+    {
+        const LNode *lnode = this->data;
+
+        for (size_type s = 0; s < this->segments.size(); ++s)
+        {
+            const auto &seg = this->segments[s];
+            size_type leaf_cnt = 0;
+
+            if (s && this->first_keys[s - 1] > this->first_keys[s])
+                return false;
+
+            for (size_type i = 0; i < seg.leaves.size(); ++i)
+            {
+                if (i && seg.keys[i - 1] > seg.keys[i])
+                    return false;
+                if (i && seg.leaves[i] == seg.leaves[i - 1])
+                    continue;
+                if (seg.leaves[i] != lnode || !lnode->key_count)
+                    return false;
+                if ((s || i) && lnode->keys[0] < (i ? seg.keys[i] : this->first_keys[s]))
+                    return false;
+
+                lnode = lnode->next;
+                ++leaf_cnt;
+            }
+
+            if (leaf_cnt != seg.leaf_count)
+                return false;
+        }
+
+        return !lnode;
+    }
+};
+
+template <size_type Degree, size_type Epsilon>
+static bool check_consistent(const CheckedTree<Degree, Epsilon> &tree, const std::string &name)
+{
+    if (tree.consistent())
+        return true;
+
+    std::cerr << name << ": segments disagree with the leafnode chain\n";
+    return false;
+}
+
+// random inserts, finds and removes against std::set, optionally on top of a bulk load
+template <size_type Degree, size_type Epsilon>
+static bool check_learned(unsigned seed, bool bulk)
+{
+    const long long RANGE = 100000;
+    const std::string NAME = "learned Degree " + std::to_string(Degree) + " Epsilon " + std::to_string(Epsilon);
+    std::mt19937 rng(seed);
+    CheckedTree<Degree, Epsilon> tree;
+    std::set<long long> keys;
+
+    if (bulk)
+    {
+        for (int i = 0; i < 3000; ++i)
+            keys.insert((long long)(rng() % RANGE) - RANGE / 2);
+        tree.bulk_load(keys.begin(), keys.end());
+    }
+
+    return check_consistent(tree, NAME) && check_ops(tree, keys, -RANGE / 2, RANGE / 2, 20000, seed, NAME) &&
+           check_consistent(tree, NAME);
+}
+
+// ascending and descending runs split the same leafnode over and over, then drain it
+template <size_type Degree, size_type Epsilon>
+static bool check_sequential(bool descending)
+{
+    const long long COUNT = 20000;
+    const std::string NAME = "learned sequential Degree " + std::to_string(Degree);
+    CheckedTree<Degree, Epsilon> tree;
+    std::set<long long> keys;
+
+    for (long long i = 0; i < COUNT; ++i)
+    {
+        long long k = descending ? COUNT - i : i;
+        tree.insert(k);
+        keys.insert(k);
+    }
+
+    if (!check_consistent(tree, NAME) || !check_keys(tree, keys, -1, COUNT + 2, NAME))
+        return false;
+
+    for (long long i = 0; i < COUNT; i += 2)
+        if (!tree.remove(descending ? COUNT - i : i) || !keys.erase(descending ? COUNT - i : i))
+        {
+            std::cerr << NAME << ": remove " << i << " failed\n";
+            return false;
+        }
+
+    return check_consistent(tree, NAME) && check_keys(tree, keys, -1, COUNT + 2, NAME);
+}
+
+// predictions far beyond the last slot must clamp before they turn into an index
+static bool check_extremes()
+{
+    const std::string NAME = "learned extremes";
+    LearnedBPlusTree<long long, 3> tree;
+    std::set<long long> keys;
+
+    for (long long k = 0; k < 100; ++k)
+        keys.insert(k);
+    tree.bulk_load(keys.begin(), keys.end());
+
+    if (tree.find(LLONG_MAX) || tree.find(LLONG_MIN) || !check_keys(tree, keys, -1, 101, NAME))
+    {
+        std::cerr << NAME << ": lookup of an extreme key failed\n";
+        return false;
+    }
+
+    tree.insert(LLONG_MAX);
+    tree.insert(LLONG_MIN);
+    keys.insert(LLONG_MAX);
+    keys.insert(LLONG_MIN);
+
+    return tree.find(LLONG_MAX) && tree.find(LLONG_MIN) && check_keys(tree, keys, -1, 101, NAME) &&
+           tree.remove(LLONG_MAX) && !tree.find(LLONG_MAX) && tree.remove(LLONG_MIN) && !tree.find(LLONG_MIN);
+}
+
+int main()
+{
+    bool ok = check_extremes();
+
+    for (unsigned seed = 0; seed < 3; ++seed)
+        for (int bulk = 0; bulk < 2; ++bulk)
+            ok = check_learned<3, 0>(seed, bulk) && check_learned<4, 2>(seed, bulk) &&
+                 check_learned<16, 8>(seed, bulk) && check_learned<64, 32>(seed, bulk) && ok;
+
+    for (int descending = 0; descending < 2; ++descending)
+        ok = check_sequential<3, 0>(descending) && check_sequential<16, 8>(descending) &&
+             check_sequential<64, 32>(descending) && ok;
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
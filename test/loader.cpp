@@ -0,0 +1,183 @@
+#include <cstdlib>
+#include <forward_list>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "check.h"
+#include "loader.h"
+
+// outcome of parsing one token: the value, or which exception was thrown
+struct Parsed
+{
+    long long value = 0;
+    std::string error;
+};
+
+static Parsed parse_one(const std::string &token, bool reference)
+{
+    Parsed p;
+
+    try
+    {
+        if (reference)
+            p.value = std::stoll(token);
+        else
+        {
+            std::vector<long long> keys = parse_keys<long long>(token.data(), token.size(), KeyFormat::TEXT, 1);
+            p.value = keys.size() == 1 ? keys[0] : -1;
+        }
+    }
+    catch (const std::out_of_range &)
+    {
+        p.error = "out_of_range";
+    }
+    catch (const std::invalid_argument &)
+    {
+        p.error = "invalid_argument";
+    }
+
+    return p;
+}
+
+// tokens that hit the SWAR path, its scalar continuation, signs and both ends of the range
+static bool check_tokens()
+{
+    const char *const LIKE_STOLL[] = {
+        "0", "-0", "+7", "-7", "1234567", "12345678", "123456789", "1234567812345678", "12345678123456781",
+        "0000000000000000000000000000042", "9223372036854775807", "-9223372036854775808",
+        "9223372036854775808", "-9223372036854775809", "18446744073709551615", "18446744073709551616",
+        "99999999999999999999999999", "-99999999999999999999999999"};
+    const char *const INVALID[] = {"-", "+", "12a", "1-2", "--1", "+-1", "0x10", "1.5", "12345678x"};
+    bool ok = true;
+
+    for (const char *token : LIKE_STOLL)
+    {
+        Parsed got = parse_one(token, false), want = parse_one(token, true);
+
+        if (got.error != want.error || got.value != want.value)
+        {
+            std::cerr << "tokens: " << token << " parsed as " << got.value << got.error << ", std::stoll gives "
+                      << want.value << want.error << '\n';
+            ok = false;
+        }
+    }
+
+    for (const char *token : INVALID)
+        if (parse_one(token, false).error != "invalid_argument")
+        {
+            std::cerr << "tokens: " << token << " was accepted\n";
+            ok = false;
+        }
+
+    // the limits follow KeyType, not long long
+    const std::string U32_MAX = "4294967295", U32_OVER = "4294967296", U32_NEG = "-1";
+    if (parse_keys<unsigned>(U32_MAX.data(), U32_MAX.size(), KeyFormat::TEXT)[0] != 4294967295u)
+        ok = false, std::cerr << "tokens: unsigned max rejected\n";
+    for (const std::string &token : {U32_OVER, U32_NEG})
+        try
+        {
+            parse_keys<unsigned>(token.data(), token.size(), KeyFormat::TEXT);
+            std::cerr << "tokens: unsigned " << token << " was accepted\n";
+            ok = false;
+        }
+        catch (const std::out_of_range &)
+        {
+        }
+
+    return ok;
+}
+
+// a buffer large enough for several workers gives the same keys as strtoll and as one worker
+static bool check_threads()
+{
+    const char *const SPACES[] = {" ", "\n", "\r\n", "\t", "  \v", "\f"};
+    std::mt19937_64 rng(7);
+    std::string text;
+    std::vector<long long> want;
+
+    while (text.size() < (size_type(5) << 20))
+    {
+        long long k = (long long)(rng() >> (1 + rng() % 63));
+        if (rng() % 2)
+            k = -k;
+
+        want.push_back(k);
+        text += std::to_string(k);
+        text += SPACES[rng() % 6];
+    }
+    std::sort(want.begin(), want.end());
+
+    for (unsigned threads : {1u, 2u, 4u, 7u})
+        if (parse_keys<long long>(text.data(), text.size(), KeyFormat::TEXT, threads) != want)
+        {
+            std::cerr << "threads: " << threads << " workers disagree with strtoll\n";
+            return false;
+        }
+
+    std::vector<long long> binary = want;
+    std::shuffle(binary.begin(), binary.end(), rng);
+    if (parse_keys<long long>(reinterpret_cast<const char *>(binary.data()), binary.size() * sizeof(long long),
+                              KeyFormat::BINARY, 4) != want)
+    {
+        std::cerr << "threads: binary keys disagree\n";
+        return false;
+    }
+
+    try
+    {
+        MappedFile file("/dev/null");
+        std::cerr << "threads: a character device was mapped\n";
+        return false;
+    }
+    catch (const std::system_error &)
+    {
+    }
+
+    return true;
+}
+
+// bulk_load from a forward-only range with duplicates, then ordinary updates on top
+template <size_type Degree>
+static bool check_bulk_load(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    const size_type SIZES[] = {0, 1, 2, Degree - 1, Degree, Degree * Degree + 1, 5000};
+
+    for (size_type n : SIZES)
+    {
+        std::multiset<long long> sorted;
+        for (size_type i = 0; i < n; ++i)
+            sorted.insert((long long)(rng() % (n + 1)) * 3);
+
+        std::forward_list<long long> keys(sorted.begin(), sorted.end());
+        std::set<long long> model(sorted.begin(), sorted.end());
+        BPlusTree<long long, Degree> tree;
+        std::string name = "bulk_load Degree " + std::to_string(Degree) + " n " + std::to_string(n);
+
+        tree.insert(-1); // replaced by the load
+        tree.bulk_load(keys.begin(), keys.end());
+
+        if (!check_keys(tree, model, -2, (long long)(n + 2) * 3, name) ||
+            !check_ops(tree, model, -10, (long long)(n + 2) * 3, 20000, seed, name))
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    bool ok = check_tokens();
+    ok = check_threads() && ok;
+
+    for (unsigned seed = 0; seed < 3; ++seed)
+        ok = check_bulk_load<3>(seed) && check_bulk_load<4>(seed) && check_bulk_load<5>(seed) &&
+             check_bulk_load<16>(seed) && check_bulk_load<64>(seed) && ok;
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
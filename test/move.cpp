@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include "bptree.h"
+#include "check.h"
+
+// heap-backed key that counts how often it is copied or moved
+struct CountedKey
+{
+    static unsigned long copies, moves;
+
+    std::string value;
+
+    CountedKey() = default;
+    // implicit so that the long long helpers of check.h drive it, order of n is kept
+    CountedKey(long long n)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%020llu-long-enough-to-live-on-the-heap",
+                      (unsigned long long)n ^ (1ULL << 63));
+        value = buf;
+    }
+    CountedKey(const CountedKey &other) : value(other.value) { ++copies; }
+    CountedKey(CountedKey &&other) noexcept : value(std::move(other.value)) { ++moves; }
+
+    CountedKey &operator=(const CountedKey &other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    CountedKey &operator=(CountedKey &&other) noexcept
+    {
+        value = std::move(other.value);
+        ++moves;
+        return *this;
+    }
+
+    bool operator==(const CountedKey &other) const { return value == other.value; }
+    bool operator<=(const CountedKey &other) const { return value <= other.value; }
+    bool operator<(const CountedKey &other) const { return value < other.value; }
+
+    friend std::ostream &operator<<(std::ostream &os, const CountedKey &key) { return os << key.value.substr(0, 20); }
+};
+
+unsigned long CountedKey::copies = 0, CountedKey::moves = 0;
+
+// two trees take the same keys, by const reference and by rvalue or emplace: the rvalue side must copy
+// exactly once less per insert, the separators both sides copy into indexnodes cancel out
+template <size_type Degree>
+static bool check_moves(unsigned seed)
+{
+    const long long RANGE = 3000;
+    const std::string NAME = "move Degree " + std::to_string(Degree);
+    std::mt19937 rng(seed);
+    BPlusTree<CountedKey, Degree> by_ref, by_move;
+    std::set<long long> keys;
+
+    for (int i = 0; keys.size() < RANGE / 2; ++i)
+    {
+        long long n = (long long)(rng() % RANGE);
+        if (!keys.insert(n).second) // keys stay unique
+            continue;
+
+        CountedKey key(n), tmp(n);
+        unsigned long before = CountedKey::copies;
+
+        by_ref.insert(key);
+        const unsigned long REF_COPIES = CountedKey::copies - before;
+
+        before = CountedKey::copies;
+        if (i % 2)
+            by_move.insert(std::move(tmp));
+        else
+            by_move.emplace(n);
+        const unsigned long MOVE_COPIES = CountedKey::copies - before;
+
+        // a single leafnode has no separators, so nothing at all may be copied
+        if (REF_COPIES != MOVE_COPIES + 1 || (keys.size() < Degree && MOVE_COPIES))
+        {
+            std::cerr << NAME << ": inserting " << n << " copied " << MOVE_COPIES << " times by rvalue and "
+                      << REF_COPIES << " by reference, seed " << seed << '\n';
+            return false;
+        }
+    }
+
+    if (dump(by_ref) != dump(by_move))
+    {
+        std::cerr << NAME << ": trees diverge, seed " << seed << '\n';
+        return false;
+    }
+
+    // the moved-from keys must not have left empty strings behind
+    return check_keys(by_move, keys, -1, RANGE + 1, NAME) &&
+           check_ops(by_move, keys, 0, RANGE, 5000, seed, NAME);
+}
+
+int main()
+{
+    bool ok = true;
+
+    for (unsigned seed = 0; seed < 4; ++seed)
+        ok = check_moves<3>(seed) && check_moves<4>(seed) && check_moves<5>(seed) && check_moves<16>(seed) &&
+             check_moves<64>(seed) && ok;
+
+    if (!ok)
+        std::exit(EXIT_FAILURE);
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bptree.h"
+#include "learned.h"
+
+static void usage(const char *prog)
+{
+    std::cerr << "usage: " << prog << " [--count N] [--lookups N] [--seed N]\n";
+    std::exit(EXIT_FAILURE);
+}
+
+// seconds spent on fn
+template <class Fn>
+static double timed(Fn fn)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// bulk load keys, look up probes, then insert fresh, the hit count keeps the lookups from being optimized away
+template <class Tree>
+static void run(const char *name, const std::vector<long long> &keys, const std::vector<long long> &probes,
+                const std::vector<long long> &fresh)
+{
+    Tree tree;
+    size_type hits = 0;
+
+    double load = timed([&] { tree.bulk_load(keys.begin(), keys.end()); });
+    double find = timed([&] {
+        for (size_type i = 0; i < probes.size(); ++i)
+            hits += tree.find(probes[i]);
+    });
+    double insert = timed([&] {
+        for (size_type i = 0; i < fresh.size(); ++i)
+            tree.insert(fresh[i]);
+    });
+
+    std::cout << name << ": bulk_load " << load * 1000 << " ms, find " << find * 1e9 / probes.size() << " ns, insert "
+              << insert * 1e9 / fresh.size() << " ns, " << hits << " hits\n";
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long long count = 1000000, lookups = 4000000, seed = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long long *opt = nullptr;
+
+        if (!std::strcmp(argv[i], "--count"))
+            opt = &count;
+        else if (!std::strcmp(argv[i], "--lookups"))
+            opt = &lookups;
+        else if (!std::strcmp(argv[i], "--seed"))
+            opt = &seed;
+
+        if (!opt || i + 1 == argc || '-' == argv[i + 1][0])
+            usage(argv[0]);
+
+        try
+        {
+            *opt = std::stoull(argv[++i]);
+        }
+        catch (const std::exception &)
+        {
+            usage(argv[0]);
+        }
+    }
+
+    if (!count || !lookups)
+        usage(argv[0]);
+
+    // even keys are loaded, half of the probes are odd and miss, fresh odd keys are inserted afterwards
+    std::mt19937_64 rng(seed);
+    std::vector<long long> keys, probes(lookups), fresh;
+
+    keys.reserve(count);
+    for (unsigned long long i = 0; i < count; ++i)
+        keys.push_back((long long)(rng() >> 2) & ~1LL);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    for (unsigned long long i = 0; i < lookups; ++i)
+        probes[i] = keys[rng() % keys.size()] | (long long)(rng() & 1);
+
+    fresh.reserve(count / 4);
+    for (unsigned long long i = 0; i < count / 4; ++i)
+        fresh.push_back((long long)(rng() >> 2) | 1);
+
+    std::cout << keys.size() << " keys, " << lookups << " lookups, " << fresh.size() << " inserts\n";
+    run<BPlusTree<long long, 64>>("BPlusTree<long long, 64>       ", keys, probes, fresh);
+    run<LearnedBPlusTree<long long, 64>>("LearnedBPlusTree<long long, 64>", keys, probes, fresh);
+}
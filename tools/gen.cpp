@@ -0,0 +1,528 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "loader.h"
+
+/**
+ * Every distribution maps a rank j in [0, n) to a key through a strictly increasing
+ * function, and every emission order is a permutation of the ranks, so keys are
+ * unique by construction and no lookup table is needed at any size.
+ */
+enum struct Dist
+{
+    UNIFORM,   // random order, evenly spread keys
+    SORTED,    // ascending order, evenly spread keys
+    REVERSE,   // descending order, evenly spread keys
+    ZIPFIAN,   // random order, power-law key density (dense low end, sparse tail)
+    CLUSTERED, // random order, runs of consecutive keys separated by wide gaps
+    TIMESTAMP  // nearly ascending order, jittered ticks from a large epoch base
+};
+
+struct Options
+{
+    Dist dist = Dist::UNIFORM;
+    KeyFormat fmt = KeyFormat::TEXT;
+    std::uint64_t count = 10;
+    std::uint64_t seed = 1;
+    std::uint64_t gap = 8;        // mean distance between adjacent keys
+    std::uint64_t cluster = 1000; // keys per run for CLUSTERED
+    std::uint64_t window = 1024;  // reorder window for TIMESTAMP
+    double skew = 1;              // Pareto shape of ZIPFIAN keys, smaller is heavier tailed
+    double theta = 0.99;          // skew of trace accesses
+    long long base = 1;
+    bool base_set = false;
+    unsigned threads = 0;
+    const char *output = nullptr;
+
+    // operation trace replayed against the generated key set
+    std::uint64_t ops = 0;
+    unsigned mix[4] = {10, 80, 5, 5}; // insert:find:remove:scan
+    std::uint32_t scan_len = 100;
+    const char *trace = nullptr;
+};
+
+static inline std::uint64_t mix64(std::uint64_t x)
+{
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// keyed pseudo-random permutation of [0, n): bijective mixing on the smallest power-of-two domain, plus cycle walking
+class Permutation
+{
+public:
+    Permutation(std::uint64_t n, std::uint64_t seed) : n(n)
+    {
+        while (bits < 64 && (std::uint64_t(1) << bits) < n)
+            ++bits;
+        mask = 64 == bits ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+        shift = (bits + 1) / 2;
+
+        for (unsigned round = 0; round < ROUNDS; ++round)
+            keys[round] = mix64(seed + round);
+    }
+
+    std::uint64_t operator()(std::uint64_t i) const
+    {
+        do
+            i = encrypt(i);
+        while (i >= n);
+        return i;
+    }
+
+private:
+    static const unsigned ROUNDS = 3;
+
+    // each step (add, multiply by an odd constant, xorshift) is a bijection modulo 2^bits
+    std::uint64_t encrypt(std::uint64_t x) const
+    {
+        for (unsigned round = 0; round < ROUNDS; ++round)
+        {
+            x = ((x + keys[round]) * 0x9E3779B97F4A7C15ull) & mask;
+            x ^= x >> shift;
+        }
+
+        return x;
+    }
+
+    std::uint64_t n, mask = 0, keys[ROUNDS];
+    unsigned bits = 1, shift = 1;
+};
+
+class KeyStream
+{
+public:
+    KeyStream(const Options &opt, std::uint64_t n)
+        : opt(opt), n(n), perm(n, mix64(opt.seed)), window(std::max<std::uint64_t>(1, opt.window))
+    {
+        log_n = std::log(double(n));
+        log_span = log_expm1((log_n + std::log(2.0)) / opt.skew); // quantile of the top rank
+    }
+
+    // i-th key in emission order
+    long long operator[](std::uint64_t i) const
+    {
+        return opt.base + (long long)value(rank(i));
+    }
+
+private:
+    std::uint64_t rank(std::uint64_t i) const
+    {
+        switch (opt.dist)
+        {
+        case Dist::SORTED:
+            return i;
+        case Dist::REVERSE:
+            return n - 1 - i;
+        case Dist::TIMESTAMP: // late arrivals: shuffle inside each window
+        {
+            std::uint64_t start = i - i % window, len = std::min(window, n - start);
+            return start + Permutation(len, mix64(opt.seed ^ start))(i - start);
+        }
+        default:
+            return perm(i);
+        }
+    }
+
+    // log(exp(x) - 1) without overflow for the huge quantiles of heavy tails
+    static double log_expm1(double x)
+    {
+        return x > 32 ? x + std::log1p(-std::exp(-x)) : std::log(std::expm1(x));
+    }
+
+    // strictly increasing in j
+    std::uint64_t value(std::uint64_t j) const
+    {
+        const std::uint64_t GAP = std::max<std::uint64_t>(1, opt.gap);
+
+        switch (opt.dist)
+        {
+        case Dist::ZIPFIAN: // Pareto quantile of (j + 0.5) / n scaled onto [0, n * (GAP - 1)]
+        {
+            const double X = (log_n - std::log(double(n - j) - 0.5)) / opt.skew;
+            return j + std::uint64_t(double(n) * (GAP - 1) * std::exp(log_expm1(X) - log_span));
+        }
+        case Dist::CLUSTERED:
+        {
+            const std::uint64_t RUN = std::max<std::uint64_t>(1, opt.cluster);
+            return j / RUN * RUN * GAP + j % RUN;
+        }
+        default:
+            return j * GAP + mix64(j ^ opt.seed) % GAP;
+        }
+    }
+
+    const Options &opt;
+    std::uint64_t n;
+    Permutation perm;
+    std::uint64_t window;
+    double log_n, log_span;
+};
+
+// Gray et al. "Quickly generating billion-record synthetic databases", with YCSB's incremental zeta
+class Zipfian
+{
+public:
+    explicit Zipfian(double theta) : theta(std::min(theta, 0.999)), alpha(1 / (1 - this->theta))
+    {
+        zeta2 = 1 + std::pow(0.5, this->theta);
+    }
+
+    // rank in [0, n), 0 is the most popular; n may only grow between calls
+    std::uint64_t operator()(std::uint64_t n, std::uint64_t rnd)
+    {
+        if (n != items)
+        {
+            const std::uint64_t EXACT = std::uint64_t(1) << 20;
+
+            for (; items < n && items < EXACT; ++items)
+                zetan += 1 / std::pow(double(items + 1), theta);
+
+            if (items < n) // the tail sum is within 1e-9 of its integral this far out
+            {
+                zetan += (std::pow(n + 0.5, 1 - theta) - std::pow(items + 0.5, 1 - theta)) / (1 - theta);
+                items = n;
+            }
+            eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetan);
+        }
+
+        double u = double(rnd >> 11) * (1.0 / 9007199254740992.0), uz = u * zetan;
+
+        if (uz < 1)
+            return 0;
+        if (uz < zeta2)
+            return std::min<std::uint64_t>(1, n - 1);
+        return std::min<std::uint64_t>(std::uint64_t(n * std::pow(eta * u - eta + 1, alpha)), n - 1);
+    }
+
+private:
+    double theta, alpha, zeta2, zetan = 0, eta = 0;
+    std::uint64_t items = 0;
+};
+
+class Writer
+{
+public:
+    explicit Writer(const char *path) : fp(std::fopen(path, "wb")), path(path)
+    {
+        if (!fp)
+        {
+            std::perror(path);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    ~Writer()
+    {
+        if (EOF == std::fclose(fp))
+            fail();
+    }
+
+    void write(const char *buf, size_type len)
+    {
+        if (len != std::fwrite(buf, 1, len, fp))
+            fail();
+    }
+
+private:
+    void fail()
+    {
+        std::perror(path);
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::FILE *fp;
+    const char *path;
+};
+
+static char *format_key(char *p, long long key)
+{
+    static const char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char tmp[20], *q = tmp + sizeof(tmp);
+    std::uint64_t v = key < 0 ? 0 - std::uint64_t(key) : std::uint64_t(key);
+
+    while (v >= 100)
+    {
+        q -= 2;
+        std::memcpy(q, DIGIT_PAIRS + v % 100 * 2, 2);
+        v /= 100;
+    }
+    if (v >= 10)
+    {
+        q -= 2;
+        std::memcpy(q, DIGIT_PAIRS + v * 2, 2);
+    }
+    else
+        *--q = char('0' + v);
+
+    if (key < 0)
+        *p++ = '-';
+    std::memcpy(p, q, tmp + sizeof(tmp) - q);
+    return p + (tmp + sizeof(tmp) - q);
+}
+
+static void write_keys(const Options &opt, const KeyStream &keys)
+{
+    const std::uint64_t BLOCK = std::uint64_t(1) << 20;
+    const unsigned THREADS = detail::loader_threads(opt.threads, opt.count * 8);
+    std::vector<std::string> bufs(THREADS);
+    Writer out(opt.output);
+
+    for (std::uint64_t first = 0; first < opt.count; first += BLOCK * THREADS)
+    {
+        detail::parallel_for(THREADS, [&](unsigned t) {
+            std::uint64_t lo = std::min(opt.count, first + BLOCK * t), hi = std::min(opt.count, lo + BLOCK);
+            std::string &buf = bufs[t];
+
+            buf.resize((hi - lo) * (KeyFormat::TEXT == opt.fmt ? 21 : sizeof(long long)));
+            char *p = &buf[0];
+
+            for (std::uint64_t i = lo; i < hi; ++i)
+                if (KeyFormat::TEXT == opt.fmt)
+                {
+                    p = format_key(p, keys[i]);
+                    *p++ = '\n';
+                }
+                else
+                {
+                    long long key = keys[i];
+                    std::memcpy(p, &key, sizeof(key));
+                    p += sizeof(key);
+                }
+
+            buf.resize(p - buf.data());
+        });
+
+        for (unsigned t = 0; t < THREADS; ++t)
+            out.write(bufs[t].data(), bufs[t].size());
+    }
+}
+
+/**
+ * TEXT records:   "i <key>", "f <key>", "r <key>", "s <key> <len>", one per line
+ * BINARY records: TraceRecord, native endian
+ */
+struct TraceRecord
+{
+    std::int64_t key;
+    std::uint32_t len;
+    char op;
+    char pad[3];
+};
+
+static void write_trace(const Options &opt, const KeyStream &keys)
+{
+    const unsigned TOTAL = opt.mix[0] + opt.mix[1] + opt.mix[2] + opt.mix[3];
+    const size_type FLUSH = size_type(1) << 22;
+    std::uint64_t inserted = opt.count, state = mix64(opt.seed ^ 0x7472616365ull);
+    Zipfian zipf(opt.theta);
+    std::string buf;
+    Writer out(opt.trace);
+
+    buf.reserve(FLUSH + 64);
+
+    for (std::uint64_t i = 0; i < opt.ops; ++i)
+    {
+        std::uint64_t rnd = mix64(state += 0x9E3779B97F4A7C15ull);
+        unsigned pick = rnd % TOTAL;
+        TraceRecord rec = {0, 0, 'i', {0, 0, 0}};
+
+        if (pick < opt.mix[0] || !inserted) // fresh key from the same distribution
+            rec.key = keys[inserted++];
+        else
+        {
+            // scramble popular ranks so hot keys are spread over the key space
+            std::uint64_t hot = zipf(inserted, mix64(rnd));
+            rec.key = keys[mix64(hot ^ opt.seed) % inserted];
+
+            pick -= opt.mix[0];
+            rec.op = pick < opt.mix[1] ? 'f' : pick < opt.mix[1] + opt.mix[2] ? 'r' : 's';
+            if ('s' == rec.op)
+                rec.len = opt.scan_len;
+        }
+
+        if (KeyFormat::TEXT == opt.fmt)
+        {
+            char line[48], *p = line;
+            *p++ = rec.op;
+            *p++ = ' ';
+            p = format_key(p, rec.key);
+            if ('s' == rec.op)
+            {
+                *p++ = ' ';
+                p = format_key(p, rec.len);
+            }
+            *p++ = '\n';
+            buf.append(line, p);
+        }
+        else
+            buf.append(reinterpret_cast<const char *>(&rec), sizeof(rec));
+
+        if (buf.size() >= FLUSH)
+        {
+            out.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+
+    out.write(buf.data(), buf.size());
+}
+
+static void usage(const char *prog)
+{
+    std::cerr << "usage: " << prog << " [options] <output>\n"
+              << "  --count N        number of unique keys (default 10)\n"
+              << "  --dist D         uniform | sorted | reverse | zipfian | clustered | timestamp\n"
+              << "  --seed S         seed of every random choice (default 1)\n"
+              << "  --gap G          mean distance between adjacent keys (default 8)\n"
+              << "  --base B         smallest possible key (default 1, timestamp 1700000000000000)\n"
+              << "  --skew A         pareto shape of zipfian keys, > 0 (default 1)\n"
+              << "  --theta T        zipfian skew of trace accesses in [0, 1) (default 0.99)\n"
+              << "  --cluster C      keys per run for clustered (default 1000)\n"
+              << "  --window W       reorder window for timestamp (default 1024)\n"
+              << "  --binary         write native 8-byte keys instead of text\n"
+              << "  --threads N      worker threads, 0 means one per hardware thread\n"
+              << "  --trace PATH     also write an operation trace to PATH\n"
+              << "  --ops N          number of traced operations\n"
+              << "  --mix I:F:R:S    insert:find:remove:scan weights (default 10:80:5:5)\n"
+              << "  --scan-len L     keys per scan (default 100)\n";
+    std::exit(EXIT_FAILURE);
+}
+
+// like std::stoull, but a minus sign is an error instead of a wrap around
+static std::uint64_t parse_unsigned(const char *s, std::uint64_t max = std::numeric_limits<std::uint64_t>::max())
+{
+    const char *p = s;
+    while (std::isspace(static_cast<unsigned char>(*p)))
+        ++p;
+    if ('-' == *p)
+        throw std::invalid_argument(s);
+
+    std::uint64_t v = std::stoull(p);
+    if (v > max)
+        throw std::out_of_range(s);
+    return v;
+}
+
+static Options parse_options(int argc, char *argv[])
+{
+    Options opt;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if ("--binary" == arg)
+            opt.fmt = KeyFormat::BINARY;
+        else if ('-' != arg[0] && !opt.output)
+            opt.output = argv[i];
+        else if (!has_value)
+            usage(argv[0]);
+        else if ("--count" == arg)
+            opt.count = parse_unsigned(argv[++i]);
+        else if ("--seed" == arg)
+            opt.seed = parse_unsigned(argv[++i]);
+        else if ("--gap" == arg)
+            opt.gap = parse_unsigned(argv[++i]);
+        else if ("--base" == arg)
+        {
+            opt.base = std::stoll(argv[++i]);
+            opt.base_set = true;
+        }
+        else if ("--skew" == arg)
+            opt.skew = std::stod(argv[++i]);
+        else if ("--theta" == arg)
+            opt.theta = std::stod(argv[++i]);
+        else if ("--cluster" == arg)
+            opt.cluster = parse_unsigned(argv[++i]);
+        else if ("--window" == arg)
+            opt.window = parse_unsigned(argv[++i]);
+        else if ("--threads" == arg)
+            opt.threads = unsigned(parse_unsigned(argv[++i], std::numeric_limits<unsigned>::max()));
+        else if ("--trace" == arg)
+            opt.trace = argv[++i];
+        else if ("--ops" == arg)
+            opt.ops = parse_unsigned(argv[++i]);
+        else if ("--scan-len" == arg)
+            opt.scan_len = std::uint32_t(parse_unsigned(argv[++i], std::numeric_limits<std::uint32_t>::max()));
+        else if ("--mix" == arg)
+        {
+            if (4 != std::sscanf(argv[++i], "%u:%u:%u:%u", &opt.mix[0], &opt.mix[1], &opt.mix[2], &opt.mix[3]) ||
+                !(opt.mix[0] + opt.mix[1] + opt.mix[2] + opt.mix[3]))
+                usage(argv[0]);
+        }
+        else if ("--dist" == arg)
+        {
+            std::string d = argv[++i];
+
+            if ("uniform" == d)
+                opt.dist = Dist::UNIFORM;
+            else if ("sorted" == d)
+                opt.dist = Dist::SORTED;
+            else if ("reverse" == d)
+                opt.dist = Dist::REVERSE;
+            else if ("zipfian" == d)
+                opt.dist = Dist::ZIPFIAN;
+            else if ("clustered" == d)
+                opt.dist = Dist::CLUSTERED;
+            else if ("timestamp" == d)
+                opt.dist = Dist::TIMESTAMP;
+            else
+                usage(argv[0]);
+        }
+        else
+            usage(argv[0]);
+    }
+
+    if (!opt.output || (opt.ops && !opt.trace) || opt.theta < 0 || opt.theta >= 1 || !(opt.skew > 0))
+        usage(argv[0]);
+
+    if (Dist::TIMESTAMP == opt.dist && !opt.base_set)
+        opt.base = 1700000000000000ll; // microseconds since the epoch, late 2023
+
+    // every key is below base + ranks * gap, see KeyStream::value(), and must fit in long long
+    const std::uint64_t GAP = std::max<std::uint64_t>(1, opt.gap);
+    const std::uint64_t ROOM = std::uint64_t(std::numeric_limits<long long>::max()) - std::uint64_t(opt.base);
+
+    if (opt.ops > std::numeric_limits<std::uint64_t>::max() - opt.count || (opt.count + opt.ops) > ROOM / GAP)
+        usage(argv[0]);
+
+    return opt;
+}
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+
+    try
+    {
+        opt = parse_options(argc, argv);
+    }
+    catch (const std::exception &)
+    {
+        usage(argv[0]);
+    }
+
+    // reserve ranks for keys inserted by the trace so they never collide with the key set
+    KeyStream keys(opt, opt.count + (opt.trace ? opt.ops : 0));
+
+    write_keys(opt, keys);
+
+    if (opt.trace)
+        write_trace(opt, keys);
+}
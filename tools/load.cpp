@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "loader.h"
+
+static void usage(const char *prog)
+{
+    std::cerr << "usage: " << prog << " [--binary] [--threads N] [--print] <key_file>\n";
+    std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    KeyFormat fmt = KeyFormat::TEXT;
+    unsigned threads = 0;
+    bool print = false;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--binary"))
+            fmt = KeyFormat::BINARY;
+        else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            try
+            {
+                threads = unsigned(std::stoul(argv[++i]));
+            }
+            catch (const std::exception &)
+            {
+                usage(argv[0]);
+            }
+        }
+        else if (!std::strcmp(argv[i], "--print"))
+            print = true;
+        else if ('-' != argv[i][0] && !path)
+            path = argv[i];
+        else
+            usage(argv[0]);
+    }
+
+    if (!path)
+        usage(argv[0]);
+
+    BPlusTree<long long, 64> bpt;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    try
+    {
+        load_file(bpt, path, fmt, threads);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << path << ": " << e.what() << '\n';
+        std::exit(EXIT_FAILURE);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (print)
+        std::cout << bpt << '\n';
+
+    std::cerr << "loaded " << path << " in " << seconds * 1000 << " ms\n";
+}